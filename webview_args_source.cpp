@@ -0,0 +1,115 @@
+#include "webview_args_source.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+
+#include <boost/nowide/cstdlib.hpp>
+#include <nlohmann/json.hpp>
+
+namespace {
+uint8_t ParseUint8(const std::string& name, const std::string& value) {
+    unsigned long parsed = std::stoul(value);
+    if (parsed > UINT8_MAX) {
+        throw std::out_of_range(name + " is out of range: " + value);
+    }
+    return static_cast<uint8_t>(parsed);
+}
+}  // namespace
+
+std::filesystem::path WebViewArgsSource::GetCachePath() const {
+    return {};
+}
+
+bool WebViewArgsSource::ReadDoesIo() const {
+    return true;
+}
+
+WebViewInMemoryArgsSource::WebViewInMemoryArgsSource(WebViewCreationArguments args)
+    : args_(std::move(args)) {}
+
+const char* WebViewInMemoryArgsSource::GetName() const {
+    return "in_memory";
+}
+
+WebViewCreationArguments WebViewInMemoryArgsSource::Read() {
+    return args_;
+}
+
+bool WebViewInMemoryArgsSource::ReadDoesIo() const {
+    return false;
+}
+
+WebViewJsonFileArgsSource::WebViewJsonFileArgsSource(std::filesystem::path cache_args_path)
+    : cache_args_path_(std::move(cache_args_path)) {}
+
+const char* WebViewJsonFileArgsSource::GetName() const {
+    return "json_file";
+}
+
+WebViewCreationArguments WebViewJsonFileArgsSource::Read() {
+    std::ifstream cache_file(cache_args_path_);
+    cache_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    nlohmann::json j;
+    cache_file >> j;
+    return j.get<WebViewCreationArguments>();
+}
+
+std::filesystem::path WebViewJsonFileArgsSource::GetCachePath() const {
+    return cache_args_path_;
+}
+
+WebViewEnvironmentArgsSource::WebViewEnvironmentArgsSource(std::string prefix)
+    : prefix_(std::move(prefix)) {}
+
+const char* WebViewEnvironmentArgsSource::GetName() const {
+    return "environment";
+}
+
+WebViewCreationArguments WebViewEnvironmentArgsSource::Read() {
+    bool found = false;
+    auto get = [this, &found](const char* field) -> std::optional<std::string> {
+        // UTF-8 on Windows too.
+        const char* value = boost::nowide::getenv((prefix_ + field).c_str());
+        if (value == nullptr) {
+            return std::nullopt;
+        }
+        found = true;
+        return std::string(value);
+    };
+
+    WebViewCreationArguments args;
+    if (auto value = get("BROWSER_EXE_PATH")) {
+        args.browser_exe_path = *value;
+    }
+    if (auto value = get("USER_DATA_DIR")) {
+        args.user_data_dir = *value;
+    }
+    if (auto value = get("ADDITIONAL_BROWSER_ARGUMENTS")) {
+        args.additional_browser_arguments = *value;
+    }
+    if (auto value = get("LANGUAGE")) {
+        args.language = *value;
+    }
+    if (auto value = get("RELEASE_CHANNELS_MASK")) {
+        args.release_channels_mask = ParseUint8(prefix_ + "RELEASE_CHANNELS_MASK", *value);
+    }
+    if (auto value = get("CHANNEL_SEARCH_KIND")) {
+        args.channel_search_kind = ParseUint8(prefix_ + "CHANNEL_SEARCH_KIND", *value);
+    }
+    if (auto value = get("ENABLE_TRACKING_PREVENTION")) {
+        args.enable_tracking_prevention = *value == "1" || *value == "true";
+    }
+
+    if (!found) {
+        throw std::runtime_error("No " + prefix_ + "* environment variables are set");
+    }
+    return args;
+}
+
+bool WebViewEnvironmentArgsSource::ReadDoesIo() const {
+    // The environment block is already in the process's memory.
+    return false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "webview_creation_arguments.hpp"
+
+// Where a pre-launch gets its WebViewCreationArguments from.  The background launch reads sources
+// doing I/O on its worker thread, and records the source's name and how long the read took.
+class WebViewArgsSource {
+public:
+  virtual ~WebViewArgsSource() = default;
+
+  // Short name recorded in telemetry, e.g. "json_file".
+  virtual const char* GetName() const = 0;
+
+  // Throws when the args can't be read.
+  virtual WebViewCreationArguments Read() = 0;
+
+  // The file the args are cached in, next to which the runtime the launch ran against is
+  // recorded.  Empty for sources without one, whose launches can't tell runtime updates apart.
+  virtual std::filesystem::path GetCachePath() const;
+
+  // Whether Read waits on I/O, which makes it worth overlapping with the launch thread's own
+  // setup.  Sources that only copy are read on the launch thread instead of starting a worker.
+  virtual bool ReadDoesIo() const;
+};
+
+// Args the host already has at hand, e.g. from its command line or compiled-in defaults.  Reading
+// them is a copy, with no I/O at all.
+class WebViewInMemoryArgsSource : public WebViewArgsSource {
+public:
+  explicit WebViewInMemoryArgsSource(WebViewCreationArguments args);
+
+  const char* GetName() const override;
+  WebViewCreationArguments Read() override;
+  bool ReadDoesIo() const override;
+
+private:
+  WebViewCreationArguments args_;
+};
+
+// Args cached as JSON by CacheWebViewCreationArguments, read through a stream.
+class WebViewJsonFileArgsSource : public WebViewArgsSource {
+public:
+  explicit WebViewJsonFileArgsSource(std::filesystem::path cache_args_path);
+
+  const char* GetName() const override;
+  WebViewCreationArguments Read() override;
+  std::filesystem::path GetCachePath() const override;
+
+private:
+  std::filesystem::path cache_args_path_;
+};
+
+// Args from environment variables named |prefix| followed by the upper-cased field name, e.g.
+// WEBVIEW_PRELAUNCH_USER_DATA_DIR.  Fields without a variable keep their defaults, but at least
+// one must be set.  Numeric fields are decimal, and enable_tracking_prevention is "1" or "true".
+class WebViewEnvironmentArgsSource : public WebViewArgsSource {
+public:
+  explicit WebViewEnvironmentArgsSource(std::string prefix = "WEBVIEW_PRELAUNCH_");
+
+  const char* GetName() const override;
+  WebViewCreationArguments Read() override;
+  bool ReadDoesIo() const override;
+
+private:
+  std::string prefix_;
+};
@@ -0,0 +1,34 @@
+#include "webview_args_source_win.hpp"
+
+#include <nlohmann/json.hpp>
+#include <wil/resource.h>
+#include <windows.h>
+
+WebViewMappedFileArgsSource::WebViewMappedFileArgsSource(std::filesystem::path cache_args_path)
+    : cache_args_path_(std::move(cache_args_path)) {}
+
+const char* WebViewMappedFileArgsSource::GetName() const {
+    return "mapped_file";
+}
+
+WebViewCreationArguments WebViewMappedFileArgsSource::Read() {
+    wil::unique_hfile file(CreateFileW(cache_args_path_.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                       nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+    THROW_LAST_ERROR_IF(!file);
+
+    LARGE_INTEGER size = {};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+    // An empty file can't be mapped, and doesn't hold args either.
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), size.QuadPart == 0);
+
+    wil::unique_handle mapping(CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    THROW_LAST_ERROR_IF_NULL(mapping.get());
+    wil::unique_mapview_ptr<const char> view(static_cast<const char*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+    THROW_LAST_ERROR_IF_NULL(view.get());
+
+    return nlohmann::json::parse(view.get(), view.get() + size.QuadPart).get<WebViewCreationArguments>();
+}
+
+std::filesystem::path WebViewMappedFileArgsSource::GetCachePath() const {
+    return cache_args_path_;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <filesystem>
+
+#include "webview_args_source.hpp"
+
+// Args cached as JSON, like WebViewJsonFileArgsSource, but parsed straight out of a read-only
+// mapping of the file rather than copied through a stream buffer.
+class WebViewMappedFileArgsSource : public WebViewArgsSource {
+public:
+    explicit WebViewMappedFileArgsSource(std::filesystem::path cache_args_path);
+
+    const char* GetName() const override;
+    WebViewCreationArguments Read() override;
+    std::filesystem::path GetCachePath() const override;
+
+private:
+    std::filesystem::path cache_args_path_;
+};
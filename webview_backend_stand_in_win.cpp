@@ -0,0 +1,239 @@
+#include "webview_backend_stand_in_win.hpp"
+
+#include <map>
+#include <thread>
+
+namespace {
+constexpr UINT kStandInTaskMessage = WM_APP + 2;
+
+LRESULT CALLBACK StandInWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+// Runs completions on the thread that requested them via a message-only window, the same way
+// WebView2 completes through the caller's message loop.  One per thread, created on first use.
+class StandInDispatcher {
+public:
+    StandInDispatcher() {
+        const char CLASS_NAME[] = "WebViewStandInBackendClass";
+        WNDCLASS wc = { };
+
+        wc.lpfnWndProc = StandInWindowProc;
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = CLASS_NAME;
+
+        RegisterClass(&wc);
+
+        hwnd_ = CreateWindowEx(0, CLASS_NAME, "WebView StandIn", 0, 0, 0, 0, 0,
+                               HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL);
+        THROW_LAST_ERROR_IF_NULL(hwnd_);
+    }
+
+    ~StandInDispatcher() {
+        // Completions that never ran would otherwise leak their closures.
+        MSG msg = {};
+        while (PeekMessage(&msg, hwnd_, kStandInTaskMessage, kStandInTaskMessage, PM_REMOVE)) {
+            delete reinterpret_cast<std::function<void()>*>(msg.lParam);
+        }
+        DestroyWindow(hwnd_);
+    }
+
+    void Post(std::chrono::milliseconds delay, std::function<void()> task) {
+        if (delay == std::chrono::milliseconds::zero()) {
+            auto heap_task = std::make_unique<std::function<void()>>(std::move(task));
+            THROW_IF_WIN32_BOOL_FALSE(PostMessage(hwnd_, kStandInTaskMessage, 0, reinterpret_cast<LPARAM>(heap_task.get())));
+            heap_task.release();
+            return;
+        }
+
+        UINT_PTR timer_id = ++last_timer_id_;
+        THROW_LAST_ERROR_IF(SetTimer(hwnd_, timer_id, static_cast<UINT>(delay.count()), nullptr) == 0);
+        delayed_tasks_[timer_id] = std::move(task);
+    }
+
+    void RunDelayedTask(UINT_PTR timer_id) {
+        KillTimer(hwnd_, timer_id);
+        auto delayed_task = delayed_tasks_.find(timer_id);
+        if (delayed_task == delayed_tasks_.end()) {
+            return;
+        }
+        auto task = std::move(delayed_task->second);
+        delayed_tasks_.erase(delayed_task);
+        task();
+    }
+
+private:
+    HWND hwnd_ = nullptr;
+    UINT_PTR last_timer_id_ = 0;
+    std::map<UINT_PTR, std::function<void()>> delayed_tasks_;
+};
+
+StandInDispatcher& GetDispatcher() {
+    thread_local StandInDispatcher dispatcher;
+    return dispatcher;
+}
+
+LRESULT CALLBACK StandInWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    switch (uMsg) {
+        case kStandInTaskMessage: {
+            std::unique_ptr<std::function<void()>> task(reinterpret_cast<std::function<void()>*>(lParam));
+            (*task)();
+            return 0;
+        }
+        case WM_TIMER:
+            GetDispatcher().RunDelayedTask(wParam);
+            return 0;
+        default:
+            return DefWindowProc(hwnd, uMsg, wParam, lParam);
+    }
+}
+
+class StandInController : public WebViewBackendController {
+public:
+    StandInController(HWND parent, const WebViewStandInBackendOptions& options, std::shared_ptr<WebViewStandInBackend::Counters> counters)
+        : parent_(parent), options_(options), counters_(std::move(counters)) {
+        ++counters_->controllers_created;
+        ++counters_->live_controllers;
+    }
+
+    ~StandInController() override {
+        --counters_->live_controllers;
+    }
+
+    uint32_t GetBrowserProcessId() override {
+        return options_.browser_process_id;
+    }
+
+    HWND GetParentWindow() override {
+        return parent_;
+    }
+
+    void SetParentWindow(HWND parent) override {
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), closed_);
+        parent_ = parent;
+    }
+
+    void Close() override {
+        closed_ = true;
+    }
+
+    void Navigate(const std::string& url, WebViewNavigationCompletedHandler on_completed) override {
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), closed_);
+        ++counters_->navigations;
+
+        // The posted completion only holds a weak reference so it is dropped along with the
+        // controller, and is a no-op if the navigation was stopped first.
+        pending_navigation_ = std::make_shared<WebViewNavigationCompletedHandler>(std::move(on_completed));
+        std::weak_ptr<WebViewNavigationCompletedHandler> weak_navigation = pending_navigation_;
+        GetDispatcher().Post(options_.navigation_latency, [weak_navigation, is_success = options_.navigation_succeeds]() {
+            CompleteNavigation(weak_navigation.lock(), is_success);
+        });
+    }
+
+    void StopNavigation() override {
+        std::weak_ptr<WebViewNavigationCompletedHandler> weak_navigation = pending_navigation_;
+        GetDispatcher().Post(std::chrono::milliseconds::zero(), [weak_navigation]() {
+            CompleteNavigation(weak_navigation.lock(), /*is_success*/false);
+        });
+    }
+
+    ICoreWebView2Controller* GetCoreWebView2Controller() override {
+        return nullptr;
+    }
+
+private:
+    static void CompleteNavigation(std::shared_ptr<WebViewNavigationCompletedHandler> navigation, bool is_success) {
+        if (!navigation || !*navigation) {
+            return;
+        }
+        auto on_completed = std::move(*navigation);
+        *navigation = nullptr;
+        on_completed(is_success);
+    }
+
+    HWND parent_ = nullptr;
+    WebViewStandInBackendOptions options_;
+    bool closed_ = false;
+    std::shared_ptr<WebViewNavigationCompletedHandler> pending_navigation_;
+    std::shared_ptr<WebViewStandInBackend::Counters> counters_;
+};
+
+class StandInEnvironment : public WebViewBackendEnvironment {
+public:
+    StandInEnvironment(const WebViewStandInBackendOptions& options, std::shared_ptr<WebViewStandInBackend::Counters> counters)
+        : options_(options), counters_(std::move(counters)) {
+        ++counters_->environments_created;
+        ++counters_->live_environments;
+    }
+
+    ~StandInEnvironment() override {
+        --counters_->live_environments;
+    }
+
+    void CreateController(HWND parent,
+                          const std::string& profile_name,
+                          WebViewControllerCreatedHandler on_created) override {
+        GetDispatcher().Post(options_.controller_creation_latency,
+            [parent, options = options_, counters = counters_, on_created = std::move(on_created)]() {
+                if (FAILED(options.controller_creation_result)) {
+                    on_created(options.controller_creation_result, nullptr);
+                    return;
+                }
+                on_created(S_OK, std::make_shared<StandInController>(parent, options, counters));
+            });
+    }
+
+    ICoreWebView2Environment* GetCoreWebView2Environment() override {
+        return nullptr;
+    }
+
+private:
+    WebViewStandInBackendOptions options_;
+    std::shared_ptr<WebViewStandInBackend::Counters> counters_;
+};
+}  // namespace
+
+WebViewStandInBackend::WebViewStandInBackend(WebViewStandInBackendOptions options)
+    : options_(options), counters_(std::make_shared<Counters>()) {}
+
+void WebViewStandInBackend::CreateEnvironment(std::shared_ptr<const WebViewEnvironmentOptions> options,
+                                              WebViewEnvironmentCreatedHandler on_created) {
+    GetDispatcher().Post(options_.environment_creation_latency,
+        [options = options_, counters = counters_, on_created = std::move(on_created)]() {
+            if (FAILED(options.environment_creation_result)) {
+                on_created(options.environment_creation_result, nullptr);
+                return;
+            }
+            on_created(S_OK, std::make_shared<StandInEnvironment>(options, counters));
+        });
+}
+
+wil::unique_handle WebViewStandInBackend::OpenBrowserProcess(uint32_t browser_process_id) {
+    // There is no browser process to wait on, so hand back an event that is already signaled, or
+    // a timer that is once the exit latency has passed.
+    if (options_.browser_exit_latency == std::chrono::milliseconds::zero()) {
+        wil::unique_handle exited(CreateEventW(nullptr, /*bManualReset*/TRUE, /*bInitialState*/TRUE, nullptr));
+        THROW_LAST_ERROR_IF_NULL(exited.get());
+        return exited;
+    }
+
+    wil::unique_handle exited(CreateWaitableTimerW(nullptr, /*bManualReset*/TRUE, nullptr));
+    THROW_LAST_ERROR_IF_NULL(exited.get());
+    // Relative due times are negative, in 100ns units.
+    LARGE_INTEGER due_time = {};
+    due_time.QuadPart = -std::chrono::duration_cast<std::chrono::duration<int64_t, std::ratio<1, 10'000'000>>>(
+        options_.browser_exit_latency).count();
+    THROW_IF_WIN32_BOOL_FALSE(SetWaitableTimer(exited.get(), &due_time, 0, nullptr, nullptr, FALSE));
+    return exited;
+}
+
+std::string WebViewStandInBackend::GetAvailableRuntimeVersion(const WebViewEnvironmentOptions& options) {
+    std::this_thread::sleep_for(options_.runtime_resolution_latency);
+    return options_.runtime_version;
+}
+
+std::filesystem::path WebViewStandInBackend::GetBrowserExecutablePath(uint32_t browser_process_id) {
+    return options_.browser_executable_path;
+}
+
+const WebViewStandInBackend::Counters& WebViewStandInBackend::GetCounters() const {
+    return *counters_;
+}
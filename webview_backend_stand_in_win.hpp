@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "webview_backend_win.hpp"
+
+struct WebViewStandInBackendOptions {
+    std::chrono::milliseconds environment_creation_latency = std::chrono::milliseconds::zero();
+    std::chrono::milliseconds controller_creation_latency = std::chrono::milliseconds::zero();
+    HRESULT environment_creation_result = S_OK;
+    HRESULT controller_creation_result = S_OK;
+    std::chrono::milliseconds navigation_latency = std::chrono::milliseconds::zero();
+    bool navigation_succeeds = true;
+    uint32_t browser_process_id = 1;
+    // Time from OpenBrowserProcess until the handle it returns is signaled, standing in for the
+    // browser process taking a while to exit.
+    std::chrono::milliseconds browser_exit_latency = std::chrono::milliseconds::zero();
+    std::string runtime_version = "1.0.0.0";
+    // Time GetAvailableRuntimeVersion takes, standing in for resolving the runtime being slow.
+    std::chrono::milliseconds runtime_resolution_latency = std::chrono::milliseconds::zero();
+    // Reported as the browser process's executable.  Point it at a real file for the pre-launch
+    // to record the runtime's identity.
+    std::filesystem::path browser_executable_path;
+};
+
+// Backend standing in for the WebView2 runtime in tests.  Completions are delivered through the
+// calling thread's message loop after the configured latency, mirroring WebView2's behavior, and
+// counters record every round trip so tests can check what was (re)created and what leaked.
+class WebViewStandInBackend : public WebViewBackend {
+public:
+    struct Counters {
+        std::atomic<uint32_t> environments_created = 0;
+        std::atomic<uint32_t> controllers_created = 0;
+        std::atomic<int32_t> live_environments = 0;
+        std::atomic<int32_t> live_controllers = 0;
+        std::atomic<uint32_t> navigations = 0;
+    };
+
+    explicit WebViewStandInBackend(WebViewStandInBackendOptions options = {});
+
+    void CreateEnvironment(std::shared_ptr<const WebViewEnvironmentOptions> options,
+                           WebViewEnvironmentCreatedHandler on_created) override;
+    wil::unique_handle OpenBrowserProcess(uint32_t browser_process_id) override;
+    std::string GetAvailableRuntimeVersion(const WebViewEnvironmentOptions& options) override;
+    std::filesystem::path GetBrowserExecutablePath(uint32_t browser_process_id) override;
+
+    const Counters& GetCounters() const;
+
+private:
+    WebViewStandInBackendOptions options_;
+    std::shared_ptr<Counters> counters_;
+};
@@ -0,0 +1,162 @@
+#include "webview_backend_webview2_win.hpp"
+
+#include <boost/nowide/convert.hpp>
+#include <wil/com.h>
+#include <wrl.h>
+#include <wrl/event.h>
+
+namespace {
+class WebView2Controller : public WebViewBackendController {
+public:
+    explicit WebView2Controller(ICoreWebView2Controller* controller) : controller_(controller) {}
+
+    uint32_t GetBrowserProcessId() override {
+        wil::com_ptr<ICoreWebView2> webview;
+        THROW_IF_FAILED(controller_->get_CoreWebView2(&webview));
+
+        uint32_t browser_process_id = 0;
+        THROW_IF_FAILED(webview->get_BrowserProcessId(&browser_process_id));
+        return browser_process_id;
+    }
+
+    HWND GetParentWindow() override {
+        HWND parent = nullptr;
+        THROW_IF_FAILED(controller_->get_ParentWindow(&parent));
+        return parent;
+    }
+
+    void SetParentWindow(HWND parent) override {
+        THROW_IF_FAILED(controller_->put_ParentWindow(parent));
+    }
+
+    void Close() override {
+        THROW_IF_FAILED(controller_->Close());
+    }
+
+    void Navigate(const std::string& url, WebViewNavigationCompletedHandler on_completed) override {
+        wil::com_ptr<ICoreWebView2> webview;
+        THROW_IF_FAILED(controller_->get_CoreWebView2(&webview));
+
+        // Registered per navigation and removed by its first completion.
+        auto token = std::make_shared<EventRegistrationToken>();
+        THROW_IF_FAILED(webview->add_NavigationCompleted(
+            Microsoft::WRL::Callback<ICoreWebView2NavigationCompletedEventHandler>(
+                [token, on_completed = std::move(on_completed)](ICoreWebView2* sender, ICoreWebView2NavigationCompletedEventArgs* args) -> HRESULT {
+                    // Copied out first since removing the handler can release this lambda.
+                    auto completed = on_completed;
+                    sender->remove_NavigationCompleted(*token);
+
+                    BOOL is_success = FALSE;
+                    HRESULT hr = args->get_IsSuccess(&is_success);
+                    completed(SUCCEEDED(hr) && is_success);
+                    return S_OK;
+                }).Get(),
+            token.get()));
+
+        std::wstring wide_url = boost::nowide::widen(url);
+        HRESULT hr = webview->Navigate(wide_url.c_str());
+        if (FAILED(hr)) {
+            webview->remove_NavigationCompleted(*token);
+            THROW_HR(hr);
+        }
+    }
+
+    void StopNavigation() override {
+        wil::com_ptr<ICoreWebView2> webview;
+        THROW_IF_FAILED(controller_->get_CoreWebView2(&webview));
+        THROW_IF_FAILED(webview->Stop());
+    }
+
+    ICoreWebView2Controller* GetCoreWebView2Controller() override {
+        return controller_.get();
+    }
+
+private:
+    wil::com_ptr<ICoreWebView2Controller> controller_;
+};
+
+class WebView2Environment : public WebViewBackendEnvironment {
+public:
+    explicit WebView2Environment(ICoreWebView2Environment* environment) : environment_(environment) {}
+
+    void CreateController(HWND parent,
+                          const std::string& profile_name,
+                          WebViewControllerCreatedHandler on_created) override {
+        auto completed_handler = Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
+            [on_created = std::move(on_created)](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT {
+                std::shared_ptr<WebViewBackendController> backend_controller;
+                if (SUCCEEDED(result)) {
+                    backend_controller = std::make_shared<WebView2Controller>(controller);
+                }
+                return on_created(result, std::move(backend_controller));
+            });
+
+        if (profile_name.empty()) {
+            THROW_IF_FAILED(environment_->CreateCoreWebView2Controller(parent, completed_handler.Get()));
+            return;
+        }
+
+        auto environment10 = environment_.query<ICoreWebView2Environment10>();
+        wil::com_ptr<ICoreWebView2ControllerOptions> controller_options;
+        THROW_IF_FAILED(environment10->CreateCoreWebView2ControllerOptions(&controller_options));
+
+        std::wstring wide_profile_name = boost::nowide::widen(profile_name);
+        THROW_IF_FAILED(controller_options->put_ProfileName(wide_profile_name.c_str()));
+        THROW_IF_FAILED(environment10->CreateCoreWebView2ControllerWithOptions(
+            parent, controller_options.get(), completed_handler.Get()));
+    }
+
+    ICoreWebView2Environment* GetCoreWebView2Environment() override {
+        return environment_.get();
+    }
+
+private:
+    wil::com_ptr<ICoreWebView2Environment> environment_;
+};
+}  // namespace
+
+void WebViewBackendWebView2::CreateEnvironment(std::shared_ptr<const WebViewEnvironmentOptions> options,
+                                               WebViewEnvironmentCreatedHandler on_created) {
+    HRESULT hr = options->CreateCoreWebView2Environment(
+        Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
+            [on_created = std::move(on_created)](HRESULT result, ICoreWebView2Environment* env) -> HRESULT {
+                std::shared_ptr<WebViewBackendEnvironment> backend_environment;
+                if (SUCCEEDED(result)) {
+                    backend_environment = std::make_shared<WebView2Environment>(env);
+                }
+                return on_created(result, std::move(backend_environment));
+            }).Get());
+    THROW_IF_FAILED(hr);
+}
+
+wil::unique_handle WebViewBackendWebView2::OpenBrowserProcess(uint32_t browser_process_id) {
+    wil::unique_handle browser_process(::OpenProcess(SYNCHRONIZE, false, browser_process_id));
+    THROW_LAST_ERROR_IF_NULL(browser_process.get());
+    return browser_process;
+}
+
+std::string WebViewBackendWebView2::GetAvailableRuntimeVersion(const WebViewEnvironmentOptions& options) {
+    // Resolves the runtime the same way environment creation does, from the browser path or else
+    // the release channels in the options.
+    auto environment_options = options.CreateCoreWebView2EnvironmentOptions();
+    const auto& browser_exe_path = options.GetBrowserExePath();
+    wil::unique_cotaskmem_string version;
+    THROW_IF_FAILED(GetAvailableCoreWebView2BrowserVersionStringWithOptions(
+        browser_exe_path.empty() ? nullptr : browser_exe_path.c_str(), environment_options.get(), &version));
+    return boost::nowide::narrow(version.get());
+}
+
+std::filesystem::path WebViewBackendWebView2::GetBrowserExecutablePath(uint32_t browser_process_id) {
+    wil::unique_handle browser_process(::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, false, browser_process_id));
+    THROW_LAST_ERROR_IF_NULL(browser_process.get());
+
+    std::wstring executable_path(MAX_PATH, L'\0');
+    DWORD length = static_cast<DWORD>(executable_path.size());
+    while (!QueryFullProcessImageNameW(browser_process.get(), 0, executable_path.data(), &length)) {
+        THROW_LAST_ERROR_IF(GetLastError() != ERROR_INSUFFICIENT_BUFFER);
+        executable_path.resize(executable_path.size() * 2);
+        length = static_cast<DWORD>(executable_path.size());
+    }
+    executable_path.resize(length);
+    return executable_path;
+}
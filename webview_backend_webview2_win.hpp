@@ -0,0 +1,13 @@
+#pragma once
+
+#include "webview_backend_win.hpp"
+
+// Backend creating real WebView2 environments and controllers.
+class WebViewBackendWebView2 : public WebViewBackend {
+public:
+    void CreateEnvironment(std::shared_ptr<const WebViewEnvironmentOptions> options,
+                           WebViewEnvironmentCreatedHandler on_created) override;
+    wil::unique_handle OpenBrowserProcess(uint32_t browser_process_id) override;
+    std::string GetAvailableRuntimeVersion(const WebViewEnvironmentOptions& options) override;
+    std::filesystem::path GetBrowserExecutablePath(uint32_t browser_process_id) override;
+};
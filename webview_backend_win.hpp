@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <WebView2.h>
+#include <wil/resource.h>
+#include <windows.h>
+
+#include "webview_environment_options_win.hpp"
+
+// The seam between WebViewPreLaunchControllerWin and the browser runtime.  The WebView2 backend
+// is used in production; tests substitute a stand-in so launch logic runs without a browser.
+//
+// Like WebView2 itself, backend objects are bound to the thread that created the environment and
+// complete their asynchronous operations through that thread's message loop.
+
+using WebViewNavigationCompletedHandler = std::function<void(bool is_success)>;
+
+class WebViewBackendController {
+public:
+    virtual ~WebViewBackendController() = default;
+
+    virtual uint32_t GetBrowserProcessId() = 0;
+    virtual HWND GetParentWindow() = 0;
+    virtual void SetParentWindow(HWND parent) = 0;
+    virtual void Close() = 0;
+
+    // Navigates to |url| and calls |on_completed| once that navigation finishes or is stopped.
+    // Only one navigation may be outstanding at a time.
+    virtual void Navigate(const std::string& url, WebViewNavigationCompletedHandler on_completed) = 0;
+    virtual void StopNavigation() = 0;
+
+    // The underlying WebView2 controller, or null when the backend isn't WebView2.
+    virtual ICoreWebView2Controller* GetCoreWebView2Controller() = 0;
+};
+
+using WebViewControllerCreatedHandler =
+    std::function<HRESULT(HRESULT result, std::shared_ptr<WebViewBackendController> controller)>;
+
+class WebViewBackendEnvironment {
+public:
+    virtual ~WebViewBackendEnvironment() = default;
+
+    // Creates a controller parented to |parent|.  An empty |profile_name| is the default profile.
+    virtual void CreateController(HWND parent,
+                                  const std::string& profile_name,
+                                  WebViewControllerCreatedHandler on_created) = 0;
+
+    // The underlying WebView2 environment, or null when the backend isn't WebView2.
+    virtual ICoreWebView2Environment* GetCoreWebView2Environment() = 0;
+};
+
+using WebViewEnvironmentCreatedHandler =
+    std::function<HRESULT(HRESULT result, std::shared_ptr<WebViewBackendEnvironment> environment)>;
+
+class WebViewBackend {
+public:
+    virtual ~WebViewBackend() = default;
+
+    virtual void CreateEnvironment(std::shared_ptr<const WebViewEnvironmentOptions> options,
+                                   WebViewEnvironmentCreatedHandler on_created) = 0;
+
+    // Returns a handle that is signaled once the browser process exits.
+    virtual wil::unique_handle OpenBrowserProcess(uint32_t browser_process_id) = 0;
+
+    // The version of the runtime an environment created with |options| would run, found without
+    // starting it.  Unlike the rest of the backend this can be called from any thread.
+    virtual std::string GetAvailableRuntimeVersion(const WebViewEnvironmentOptions& options) = 0;
+    // The executable a running browser process was started from.
+    virtual std::filesystem::path GetBrowserExecutablePath(uint32_t browser_process_id) = 0;
+};
@@ -0,0 +1,107 @@
+#include "webview_environment_options_win.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include <boost/nowide/convert.hpp>
+#include <nlohmann/json.hpp>
+#include <WebView2EnvironmentOptions.h>
+#include <wrl.h>
+
+/* static */
+std::shared_ptr<const WebViewEnvironmentOptions> WebViewEnvironmentOptions::Get(const WebViewCreationArguments& args) {
+    // Never destroyed, since a launch abandoned by a detached close can still get here while the
+    // process exits.
+    static auto& snapshots_mutex = *new std::mutex();
+    static auto& snapshots = *new std::vector<std::weak_ptr<const WebViewEnvironmentOptions>>();
+
+    uint64_t fingerprint = ComputeFingerprint(args);
+
+    std::lock_guard<std::mutex> lock(snapshots_mutex);
+    std::erase_if(snapshots, [](const auto& snapshot) { return snapshot.expired(); });
+    for (const auto& weak_snapshot : snapshots) {
+        auto snapshot = weak_snapshot.lock();
+        if (snapshot && snapshot->fingerprint_ == fingerprint && snapshot->args_ == args) {
+            return snapshot;
+        }
+    }
+
+    auto snapshot = std::make_shared<const WebViewEnvironmentOptions>(args);
+    snapshots.push_back(snapshot);
+    return snapshot;
+}
+
+/* static */
+uint64_t WebViewEnvironmentOptions::ComputeFingerprint(const WebViewCreationArguments& args) {
+    // FNV-1a over the cached JSON form, so every field that is cached is also fingerprinted.
+    std::string serialized_args = nlohmann::json(args).dump();
+
+    uint64_t fingerprint = 14695981039346656037ULL;
+    for (unsigned char c : serialized_args) {
+        fingerprint ^= c;
+        fingerprint *= 1099511628211ULL;
+    }
+    return fingerprint;
+}
+
+WebViewEnvironmentOptions::WebViewEnvironmentOptions(const WebViewCreationArguments& args)
+    : args_(args),
+      fingerprint_(ComputeFingerprint(args)),
+      browser_exe_path_(boost::nowide::widen(args.browser_exe_path)),
+      user_data_dir_(boost::nowide::widen(args.user_data_dir)),
+      additional_browser_arguments_(boost::nowide::widen(args.additional_browser_arguments)),
+      language_(boost::nowide::widen(args.language)) {}
+
+const WebViewCreationArguments& WebViewEnvironmentOptions::GetArgs() const {
+    return args_;
+}
+
+uint64_t WebViewEnvironmentOptions::GetFingerprint() const {
+    return fingerprint_;
+}
+
+const std::wstring& WebViewEnvironmentOptions::GetBrowserExePath() const {
+    return browser_exe_path_;
+}
+
+const std::wstring& WebViewEnvironmentOptions::GetUserDataDir() const {
+    return user_data_dir_;
+}
+
+bool WebViewEnvironmentOptions::Matches(const WebViewEnvironmentOptions& other) const {
+    return fingerprint_ == other.fingerprint_ && args_ == other.args_;
+}
+
+wil::com_ptr<ICoreWebView2EnvironmentOptions> WebViewEnvironmentOptions::CreateCoreWebView2EnvironmentOptions() const {
+    auto options = Microsoft::WRL::Make<CoreWebView2EnvironmentOptions>();
+    THROW_IF_NULL_ALLOC(options);
+    THROW_IF_FAILED(options->put_AllowSingleSignOnUsingOSPrimaryAccount(true));
+
+    Microsoft::WRL::ComPtr<ICoreWebView2EnvironmentOptions7> options7;
+    options.As(&options7);
+    THROW_IF_NULL_ALLOC(options7);
+    THROW_IF_FAILED(options7->put_ChannelSearchKind(static_cast<COREWEBVIEW2_CHANNEL_SEARCH_KIND>(args_.channel_search_kind)));
+    THROW_IF_FAILED(options7->put_ReleaseChannels(static_cast<COREWEBVIEW2_RELEASE_CHANNELS>(args_.release_channels_mask)));
+
+    THROW_IF_FAILED(options->put_AdditionalBrowserArguments(additional_browser_arguments_.c_str()));
+    THROW_IF_FAILED(options->put_EnableTrackingPrevention(args_.enable_tracking_prevention));
+    THROW_IF_FAILED(options->put_Language(language_.c_str()));
+
+    wil::com_ptr<ICoreWebView2EnvironmentOptions> environment_options;
+    THROW_IF_FAILED(options.CopyTo(environment_options.put()));
+    return environment_options;
+}
+
+HRESULT WebViewEnvironmentOptions::CreateCoreWebView2Environment(
+    ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler* handler) const noexcept try {
+    auto options = CreateCoreWebView2EnvironmentOptions();
+    return CreateCoreWebView2EnvironmentWithOptions(
+        browser_exe_path_.c_str(),
+        user_data_dir_.c_str(),
+        options.get(),
+        handler);
+}
+catch(...) {
+    RETURN_CAUGHT_EXCEPTION();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <WebView2.h>
+#include <wil/com.h>
+
+#include "webview_creation_arguments.hpp"
+
+// Immutable snapshot of the WebView2 environment options derived from WebViewCreationArguments,
+// with the strings already widened and a fingerprint of the args.  The pre-launch and the host
+// must both create their environment through this class: any difference between the two turns
+// every launch into a miss, so there is exactly one place that maps args to options.
+class WebViewEnvironmentOptions {
+public:
+    // Returns the snapshot for |args|, reusing the one already built for equal args if it is
+    // still alive.  Safe to call from any thread.
+    static std::shared_ptr<const WebViewEnvironmentOptions> Get(const WebViewCreationArguments& args);
+
+    static uint64_t ComputeFingerprint(const WebViewCreationArguments& args);
+
+    const WebViewCreationArguments& GetArgs() const;
+    uint64_t GetFingerprint() const;
+    const std::wstring& GetBrowserExePath() const;
+    const std::wstring& GetUserDataDir() const;
+
+    // Environments created from snapshots with equal fingerprints share a browser process tree.
+    bool Matches(const WebViewEnvironmentOptions& other) const;
+
+    // Builds the COM options object.  It is created per call because, unlike the snapshot, it is
+    // bound to the calling thread's apartment.
+    wil::com_ptr<ICoreWebView2EnvironmentOptions> CreateCoreWebView2EnvironmentOptions() const;
+
+    // Calls CreateCoreWebView2EnvironmentWithOptions with this snapshot.
+    HRESULT CreateCoreWebView2Environment(
+        ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler* handler) const noexcept;
+
+    explicit WebViewEnvironmentOptions(const WebViewCreationArguments& args);
+
+private:
+    WebViewCreationArguments args_;
+    uint64_t fingerprint_ = 0;
+    std::wstring browser_exe_path_;
+    std::wstring user_data_dir_;
+    std::wstring additional_browser_arguments_;
+    std::wstring language_;
+};
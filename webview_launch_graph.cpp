@@ -0,0 +1,130 @@
+#include "webview_launch_graph.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "webview_prelaunch_metrics.hpp"
+
+namespace {
+enum class PhaseState { kPending, kCompleted, kFailed };
+}  // namespace
+
+void WebViewLaunchGraph::AddPhase(std::string name,
+                                  std::vector<std::string> dependencies,
+                                  bool off_launch_thread,
+                                  std::function<void()> run) {
+    auto metrics_phase = FindPhase(name);
+    Phase phase{std::move(name), metrics_phase, {}, off_launch_thread, std::move(run)};
+    for (const auto& dependency : dependencies) {
+        auto dependency_phase = std::find_if(phases_.begin(), phases_.end(),
+            [&dependency](const Phase& added_phase) { return added_phase.name == dependency; });
+        if (dependency_phase == phases_.end()) {
+            throw std::invalid_argument("Launch phase " + phase.name + " depends on unknown phase " + dependency);
+        }
+        phase.dependencies.push_back(dependency_phase - phases_.begin());
+    }
+    phases_.push_back(std::move(phase));
+}
+
+void WebViewLaunchGraph::Run(bool overlap, WebViewPreLaunchTelemetry& telemetry) {
+    std::mutex mutex;
+    std::condition_variable phase_settled;
+    std::vector<PhaseState> states(phases_.size(), PhaseState::kPending);
+    // Each slot is only written by the thread running that phase and read after both have finished.
+    std::vector<std::optional<WebViewLaunchPhaseTiming>> timings(phases_.size());
+    std::exception_ptr first_exception;
+
+    auto run_phase = [&](size_t index, bool on_worker_thread) {
+        const auto& phase = phases_[index];
+
+        bool dependencies_completed;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            phase_settled.wait(lock, [&]() {
+                return std::none_of(phase.dependencies.begin(), phase.dependencies.end(),
+                    [&states](size_t dependency) { return states[dependency] == PhaseState::kPending; });
+            });
+            dependencies_completed = std::all_of(phase.dependencies.begin(), phase.dependencies.end(),
+                [&states](size_t dependency) { return states[dependency] == PhaseState::kCompleted; });
+        }
+
+        auto state = PhaseState::kFailed;
+        if (dependencies_completed) {
+            WebViewLaunchPhaseTiming timing;
+            timing.name = phase.name;
+            for (size_t dependency : phase.dependencies) {
+                timing.dependencies.push_back(phases_[dependency].name);
+            }
+            timing.on_worker_thread = on_worker_thread;
+            timing.started = telemetry.DurationSinceLaunch();
+
+            try {
+                phase.run();
+                state = PhaseState::kCompleted;
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!first_exception) {
+                    first_exception = std::current_exception();
+                }
+            }
+
+            timing.completed = telemetry.DurationSinceLaunch();
+            if (state == PhaseState::kCompleted && phase.metrics_phase.has_value()) {
+                WebViewPreLaunchMetrics::RecordPhaseDuration(phase.metrics_phase.value(), timing.completed - timing.started);
+            }
+            timings[index] = std::move(timing);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            states[index] = state;
+        }
+        phase_settled.notify_all();
+    };
+
+    // A worker with nothing to run isn't worth starting.
+    overlap = overlap && std::any_of(phases_.begin(), phases_.end(), [](const Phase& phase) { return phase.off_launch_thread; });
+    std::thread worker;
+    if (overlap) {
+        try {
+            worker = std::thread([&]() {
+                for (size_t index = 0; index < phases_.size(); ++index) {
+                    if (phases_[index].off_launch_thread) {
+                        run_phase(index, /*on_worker_thread*/true);
+                    }
+                }
+            });
+        }
+        catch (const std::system_error&) {
+            // Without a worker the phases still complete, just in sequence.
+            overlap = false;
+        }
+    }
+
+    for (size_t index = 0; index < phases_.size(); ++index) {
+        if (!overlap || !phases_[index].off_launch_thread) {
+            run_phase(index, /*on_worker_thread*/false);
+        }
+    }
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    for (auto& timing : timings) {
+        if (timing.has_value()) {
+            telemetry.launch_phases.push_back(std::move(timing.value()));
+        }
+    }
+
+    if (first_exception) {
+        std::rethrow_exception(first_exception);
+    }
+}
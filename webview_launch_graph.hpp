@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "webview_prelaunch_controller.hpp"
+#include "webview_prelaunch_metrics.hpp"
+
+// Runs the phases of the background launch as a small dependency graph.  Phases that don't need
+// the launch thread run on a worker so they overlap with the ones that do (apartment, window and
+// WebView2 creation are bound to the launch thread); a phase starts once all its dependencies have
+// completed.  Each thread runs its phases in the order they were added.
+class WebViewLaunchGraph {
+public:
+  // |dependencies| name phases added earlier.  Phases named like a WebViewLaunchPhase have their
+  // durations recorded in WebViewPreLaunchMetrics.
+  void AddPhase(std::string name,
+                std::vector<std::string> dependencies,
+                bool off_launch_thread,
+                std::function<void()> run);
+
+  // Runs every phase, on the calling thread and, when |overlap| is set and some phase runs off the
+  // launch thread, one worker thread, and returns once they have all finished.  Without |overlap|
+  // the phases run one after another on the calling thread in the order they were added.  Phases depending on a failed phase are skipped
+  // and the first exception thrown is rethrown once all phases have finished.  The timings of the
+  // phases that ran are appended to |telemetry|.launch_phases, and the durations of the ones that
+  // completed are recorded in WebViewPreLaunchMetrics.
+  void Run(bool overlap, WebViewPreLaunchTelemetry& telemetry);
+
+private:
+  struct Phase {
+    std::string name;
+    std::optional<WebViewLaunchPhase> metrics_phase;
+    std::vector<size_t> dependencies;
+    bool off_launch_thread = false;
+    std::function<void()> run;
+  };
+
+  std::vector<Phase> phases_;
+};
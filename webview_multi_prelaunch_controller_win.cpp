@@ -0,0 +1,160 @@
+#include "webview_multi_prelaunch_controller_win.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+
+namespace {
+// Lets a target waiting for a launch slot start launching.
+constexpr char kLaunchSlotMilestone[] = "launch_slot";
+}  // namespace
+
+WebViewMultiPreLaunchControllerWin::WebViewMultiPreLaunchControllerWin(std::shared_ptr<WebViewBackend> backend)
+    : backend_(std::move(backend)) {}
+
+WebViewMultiPreLaunchControllerWin::~WebViewMultiPreLaunchControllerWin() {
+    if (!workers_.empty()) {
+        Close(/*wait_for_browser_process_exit*/false);
+        WaitForClose();
+    }
+}
+
+void WebViewMultiPreLaunchControllerWin::Launch(const std::vector<WebViewPreLaunchTarget>& targets,
+                                                const WebViewMultiPreLaunchOptions& options) {
+    if (!controllers_.empty()) {
+        throw std::logic_error("The pre-launch targets were already launched");
+    }
+
+    std::set<std::string> target_names;
+    for (const auto& target : targets) {
+        if (!target_names.insert(target.name).second) {
+            throw std::invalid_argument("Duplicate pre-launch target " + target.name);
+        }
+    }
+
+    // Every tree is launched right away with its telemetry counting from here, but holds back
+    // until a worker hands it a launch slot.
+    auto launch_start = std::chrono::high_resolution_clock::now();
+    for (const auto& target : targets) {
+        auto target_options = target.options;
+        target_options.launch_start = launch_start;
+        target_options.launch_strategy = WebViewLaunchStrategyOptions();
+        target_options.launch_strategy.strategy = WebViewLaunchStrategy::kOnMilestone;
+        target_options.launch_strategy.milestone = kLaunchSlotMilestone;
+        target_options.launch_strategy.max_deferral = std::chrono::hours(24);
+        target_options.launch_strategy_candidates.clear();
+
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend_);
+        if (target.args_source != nullptr) {
+            controller->Launch(target.args_source, target_options);
+        } else {
+            controller->Launch(target.cache_args_path, target_options);
+        }
+        controllers_.emplace(target.name, std::move(controller));
+        queued_targets_.push_back(target.name);
+    }
+
+    size_t worker_count = options.max_concurrent_launches == 0
+        ? targets.size()
+        : std::min(options.max_concurrent_launches, targets.size());
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this]() {
+            this->RunWorker();
+        });
+    }
+}
+
+void WebViewMultiPreLaunchControllerWin::RunWorker() noexcept {
+    while (true) {
+        std::shared_ptr<WebViewPreLaunchControllerWin> controller;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (closing_ || queued_targets_.empty()) {
+                return;
+            }
+            controller = controllers_.find(queued_targets_.front())->second;
+            queued_targets_.pop_front();
+        }
+
+        // The slot stays taken until the tree is ready or its launch failed.
+        controller->SignalMilestone(kLaunchSlotMilestone);
+        controller->WaitForLaunchSettled();
+    }
+}
+
+bool WebViewMultiPreLaunchControllerWin::WaitForLaunch(const std::string& target) {
+    auto controller = GetController(target);
+    if (controller == nullptr) {
+        return false;
+    }
+
+    controller->WaitForLaunch();
+    return true;
+}
+
+void WebViewMultiPreLaunchControllerWin::WaitForLaunch() {
+    for (const auto& [target, controller] : controllers_) {
+        controller->WaitForLaunch();
+    }
+}
+
+std::shared_ptr<WebViewPreLaunchControllerWin> WebViewMultiPreLaunchControllerWin::GetController(const std::string& target) const {
+    auto controller = controllers_.find(target);
+    return controller != controllers_.end() ? controller->second : nullptr;
+}
+
+std::vector<std::string> WebViewMultiPreLaunchControllerWin::GetTargets() const {
+    std::vector<std::string> targets;
+    for (const auto& [target, controller] : controllers_) {
+        targets.push_back(target);
+    }
+    return targets;
+}
+
+void WebViewMultiPreLaunchControllerWin::Close(bool wait_for_browser_process_exit) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        closing_ = true;
+        queued_targets_.clear();
+    }
+
+    // Closing abandons the launches still waiting for a slot, which also releases their waiters.
+    for (const auto& [target, controller] : controllers_) {
+        controller->Close(wait_for_browser_process_exit);
+    }
+}
+
+void WebViewMultiPreLaunchControllerWin::WaitForClose() {
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+
+    for (const auto& [target, controller] : controllers_) {
+        controller->WaitForClose();
+    }
+    closed_ = true;
+}
+
+std::map<std::string, WebViewPreLaunchTelemetry> WebViewMultiPreLaunchControllerWin::GetTelemetry() const {
+    if (!closed_) {
+        throw std::logic_error("The pre-launch telemetry is only complete once WaitForClose returned");
+    }
+
+    std::map<std::string, WebViewPreLaunchTelemetry> telemetry;
+    for (const auto& [target, controller] : controllers_) {
+        telemetry.emplace(target, controller->GetTelemetry());
+    }
+    return telemetry;
+}
+
+WebViewPreLaunchBatchAnalysis WebViewMultiPreLaunchControllerWin::AnalyzeTelemetry() const {
+    std::vector<WebViewPreLaunchTelemetry> batch;
+    for (auto& [target, telemetry] : GetTelemetry()) {
+        batch.push_back(std::move(telemetry));
+    }
+    return AnalyzePreLaunchTelemetry(batch);
+}
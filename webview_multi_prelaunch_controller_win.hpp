@@ -0,0 +1,82 @@
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "webview_backend_webview2_win.hpp"
+#include "webview_backend_win.hpp"
+#include "webview_prelaunch_controller.hpp"
+#include "webview_prelaunch_controller_win.hpp"
+#include "webview_prelaunch_telemetry_analysis.hpp"
+
+// One browser tree to pre-launch, e.g. for one tenant's user data dir.
+struct WebViewPreLaunchTarget {
+    std::string name;
+    std::filesystem::path cache_args_path;
+    // Read in place of cache_args_path when set.
+    std::shared_ptr<WebViewArgsSource> args_source = nullptr;
+    // The launch strategy is replaced by the multi-target controller's scheduling.
+    WebViewPreLaunchOptions options = {};
+};
+
+struct WebViewMultiPreLaunchOptions {
+    // Trees launching at once.  Further targets wait for one of those to be ready before starting,
+    // so that several trees don't thrash the disk starting together.  Zero launches all at once.
+    // Every target's pre-launch thread still starts right away and waits for its slot.
+    size_t max_concurrent_launches = 2;
+};
+
+// Pre-launches several independent browser trees, one WebViewPreLaunchControllerWin per target.
+// Each tree runs on its own pre-launch thread; a pool of at most max_concurrent_launches workers
+// lets targets start launching in the order given.
+class WebViewMultiPreLaunchControllerWin {
+private:
+    std::shared_ptr<WebViewBackend> backend_;
+    std::map<std::string, std::shared_ptr<WebViewPreLaunchControllerWin>> controllers_;
+    std::vector<std::thread> workers_;
+    // Guards the queue and the closing flag, which the workers share with the host.
+    std::mutex queue_mutex_;
+    std::deque<std::string> queued_targets_;
+    bool closing_ = false;
+    // Set once WaitForClose returned, after which no pre-launch thread writes its telemetry.
+    bool closed_ = false;
+
+    void RunWorker() noexcept;
+
+public:
+    explicit WebViewMultiPreLaunchControllerWin(
+        std::shared_ptr<WebViewBackend> backend = std::make_shared<WebViewBackendWebView2>());
+    ~WebViewMultiPreLaunchControllerWin();
+
+    // Throws std::invalid_argument when target names aren't unique, and std::logic_error when
+    // called a second time.
+    void Launch(const std::vector<WebViewPreLaunchTarget>& targets,
+                const WebViewMultiPreLaunchOptions& options = {});
+
+    // Blocks until |target|'s launch is completed.  Returns false for an unknown target.
+    bool WaitForLaunch(const std::string& target);
+    // Blocks until every target's launch is completed.
+    void WaitForLaunch();
+
+    // The controller for |target|, to adopt its tree or take pooled controllers once it's ready.
+    // Null for an unknown target.
+    std::shared_ptr<WebViewPreLaunchControllerWin> GetController(const std::string& target) const;
+    std::vector<std::string> GetTargets() const;
+
+    // Closes every tree.  Targets still waiting for a launch slot are never launched.
+    void Close(bool wait_for_browser_process_exit);
+    void WaitForClose();
+
+    // Each target's telemetry.  Offsets count from the multi-target Launch, so the time a target
+    // waited for a launch slot shows as its launch_deferred phase.  The pre-launch threads write it
+    // until they exit, so this throws std::logic_error until WaitForClose returned.
+    std::map<std::string, WebViewPreLaunchTelemetry> GetTelemetry() const;
+    // Every target's telemetry summarized as one batch, with the same restriction.
+    WebViewPreLaunchBatchAnalysis AnalyzeTelemetry() const;
+};
@@ -0,0 +1,141 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "webview_prelaunch_controller.hpp"
+#include "webview_prelaunch_telemetry_analysis.hpp"
+
+namespace {
+void PrintUsage() {
+    std::cerr << "Usage: webview_prelaunch_analyze [--json] [--by-strategy] [--max-blocked-ms N] "
+                 "[--min-saving-ms N] [--max-failed-runs N] <telemetry.json>...\n"
+                 "Each file holds one telemetry object or an array of them.  With more than one run a\n"
+                 "batch summary is printed, and with --by-strategy one per launch strategy.  Exits with 1\n"
+                 "when the p90 foreground blocked time is over --max-blocked-ms or the p50 estimated\n"
+                 "saving is under --min-saving-ms.  With any of the limits set, it also exits with 1 when\n"
+                 "more runs failed than --max-failed-runs, 0 by default, or none succeeded.\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    bool print_json = false;
+    bool by_strategy = false;
+    std::optional<int64_t> max_blocked_ms;
+    std::optional<int64_t> min_saving_ms;
+    std::optional<size_t> max_failed_runs;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--json") {
+                print_json = true;
+            } else if (arg == "--by-strategy") {
+                by_strategy = true;
+            } else if (arg == "--max-blocked-ms" && i + 1 < argc) {
+                max_blocked_ms = std::stoll(argv[++i]);
+            } else if (arg == "--min-saving-ms" && i + 1 < argc) {
+                min_saving_ms = std::stoll(argv[++i]);
+            } else if (arg == "--max-failed-runs" && i + 1 < argc) {
+                max_failed_runs = std::stoul(argv[++i]);
+            } else if (arg.starts_with("--")) {
+                PrintUsage();
+                return 2;
+            } else {
+                paths.push_back(arg);
+            }
+        } catch (const std::invalid_argument&) {
+            PrintUsage();
+            return 2;
+        } catch (const std::out_of_range&) {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (paths.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<WebViewPreLaunchTelemetry> batch;
+    for (const auto& path : paths) {
+        try {
+            std::ifstream telemetry_file(path);
+            telemetry_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+            nlohmann::json j;
+            telemetry_file >> j;
+            if (j.is_array()) {
+                for (const auto& run : j) {
+                    batch.push_back(run.get<WebViewPreLaunchTelemetry>());
+                }
+            } else {
+                batch.push_back(j.get<WebViewPreLaunchTelemetry>());
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to read " << path << ": " << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    // Runs from the A/B mode, grouped by the launch strategy each one picked.
+    std::map<std::string, std::vector<WebViewPreLaunchTelemetry>> strategy_batches;
+    if (by_strategy) {
+        for (const auto& telemetry : batch) {
+            strategy_batches[telemetry.launch_strategy.empty() ? "unknown" : telemetry.launch_strategy].push_back(telemetry);
+        }
+    }
+
+    auto batch_analysis = AnalyzePreLaunchTelemetry(batch);
+    if (print_json) {
+        nlohmann::json j = batch.size() == 1 ? nlohmann::json(batch_analysis.run_analyses.front())
+                                             : nlohmann::json(batch_analysis);
+        for (const auto& [strategy, strategy_batch] : strategy_batches) {
+            j["by_strategy"][strategy] = AnalyzePreLaunchTelemetry(strategy_batch);
+        }
+        std::cout << j.dump(2) << std::endl;
+    } else {
+        if (batch.size() == 1) {
+            PrintPreLaunchAnalysis(std::cout, batch_analysis.run_analyses.front());
+        } else {
+            PrintPreLaunchAnalysis(std::cout, batch_analysis);
+        }
+        for (const auto& [strategy, strategy_batch] : strategy_batches) {
+            std::cout << "\nLaunch strategy " << strategy << ":\n";
+            PrintPreLaunchAnalysis(std::cout, AnalyzePreLaunchTelemetry(strategy_batch));
+        }
+    }
+
+    int exit_code = 0;
+    bool gated = max_blocked_ms.has_value() || min_saving_ms.has_value() || max_failed_runs.has_value();
+    if (gated && batch_analysis.failed_runs > max_failed_runs.value_or(0)) {
+        std::cerr << batch_analysis.failed_runs << " of " << batch_analysis.runs << " runs failed, over the "
+                  << max_failed_runs.value_or(0) << " run limit" << std::endl;
+        exit_code = 1;
+    }
+    // The distributions only cover runs that succeeded, so without any they read as zero and would
+    // pass every limit.
+    if (gated && batch_analysis.failed_runs == batch_analysis.runs) {
+        std::cerr << "No run succeeded" << std::endl;
+        exit_code = 1;
+    }
+    if (max_blocked_ms.has_value() && batch_analysis.foreground_blocked.p90.count() > max_blocked_ms.value()) {
+        std::cerr << "p90 foreground blocked time " << batch_analysis.foreground_blocked.p90.count()
+                  << " ms is over the " << max_blocked_ms.value() << " ms limit" << std::endl;
+        exit_code = 1;
+    }
+    if (min_saving_ms.has_value() && batch_analysis.estimated_saving.p50.count() < min_saving_ms.value()) {
+        std::cerr << "p50 estimated saving " << batch_analysis.estimated_saving.p50.count()
+                  << " ms is under the " << min_saving_ms.value() << " ms minimum" << std::endl;
+        exit_code = 1;
+    }
+    return exit_code;
+}
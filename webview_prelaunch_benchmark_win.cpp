@@ -0,0 +1,268 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "webview_args_source.hpp"
+#include "webview_args_source_win.hpp"
+#include "webview_backend_stand_in_win.hpp"
+#include "webview_prelaunch_controller.hpp"
+#include "webview_prelaunch_controller_win.hpp"
+#include "webview_prelaunch_metrics.hpp"
+#include "webview_prelaunch_telemetry_analysis.hpp"
+
+namespace {
+struct BenchmarkOptions {
+    size_t runs = 20;
+    // Launch against the stand-in backend rather than the installed WebView2 runtime.
+    bool stand_in = false;
+    std::filesystem::path cache_args_path;
+};
+
+std::shared_ptr<WebViewPreLaunchControllerWin> CreateController(const BenchmarkOptions& benchmark_options,
+                                                                WebViewStandInBackendOptions stand_in_options = {}) {
+    if (benchmark_options.stand_in) {
+        return std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>(std::move(stand_in_options)));
+    }
+    return std::make_shared<WebViewPreLaunchControllerWin>();
+}
+
+void PrintSamples(const char* name, const std::vector<std::chrono::milliseconds>& samples) {
+    double sum = 0;
+    for (const auto& sample : samples) {
+        sum += static_cast<double>(sample.count());
+    }
+    auto distribution = ComputeDistribution(samples);
+
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+              << " mean " << std::fixed << std::setprecision(2) << std::setw(8)
+              << (samples.empty() ? 0.0 : sum / samples.size()) << " ms"
+              << "  p50 " << std::setw(6) << distribution.p50.count() << " ms"
+              << "  p90 " << std::setw(6) << distribution.p90.count() << " ms"
+              << "  max " << std::setw(6) << distribution.max.count() << " ms\n";
+}
+
+// Time from Launch until the environment was created, with the launch phases run in sequence as
+// before and overlapped.  The modes alternate run by run so drift affects both equally.
+int LaunchPhasesBenchmark(const BenchmarkOptions& benchmark_options) {
+    std::map<bool, std::vector<std::chrono::milliseconds>> environment_created;
+    std::map<bool, std::vector<std::chrono::milliseconds>> window_created;
+    for (size_t run = 0; run < benchmark_options.runs * 2; ++run) {
+        WebViewPreLaunchOptions options;
+        options.overlap_launch_phases = run % 2 == 1;
+
+        auto controller = CreateController(benchmark_options);
+        controller->Launch(benchmark_options.cache_args_path, options);
+        controller->WaitForLaunch();
+        controller->Close(/*wait_for_browser_process_exit*/true);
+        controller->WaitForClose();
+
+        const auto& telemetry = controller->GetTelemetry();
+        if (!telemetry.exceptions.empty()) {
+            std::cerr << "Launch failed: " << telemetry.exceptions.front() << std::endl;
+            return 1;
+        }
+        environment_created[options.overlap_launch_phases].push_back(telemetry.environment_created);
+        window_created[options.overlap_launch_phases].push_back(telemetry.window_created);
+    }
+
+    std::cout << "Time from Launch, " << benchmark_options.runs << " runs per mode:\n";
+    PrintSamples("sequential window", window_created[false]);
+    PrintSamples("overlapped window", window_created[true]);
+    PrintSamples("sequential environment", environment_created[false]);
+    PrintSamples("overlapped environment", environment_created[true]);
+    return 0;
+}
+
+// Cost of recording a milestone and a counter, as the launch does at every step, with no hook
+// registered and with one.  The loop's own cost is measured separately and subtracted.
+int MetricsOverheadBenchmark(const BenchmarkOptions& benchmark_options) {
+    constexpr size_t kIterations = 10'000'000;
+    volatile int64_t sink = 0;
+    auto time_per_iteration = [](const std::function<void(size_t)>& body) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < kIterations; ++i) {
+            body(i);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / kIterations;
+    };
+    auto record = [](size_t i) {
+        WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kAdopted, std::chrono::milliseconds(i & 1023));
+        WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kControllerPoolHits);
+    };
+    auto record_phase = [](size_t i) {
+        WebViewPreLaunchMetrics::RecordPhaseDuration(WebViewLaunchPhase::kCreateController, std::chrono::milliseconds(i & 1023));
+    };
+
+    double baseline = time_per_iteration([&sink](size_t i) { sink = sink + static_cast<int64_t>(i & 1023); });
+    double no_hooks = time_per_iteration(record);
+    double phase_no_hooks = time_per_iteration(record_phase);
+    auto hook_id = WebViewPreLaunchMetrics::AddMilestoneHook([&sink](WebViewPreLaunchMilestone, std::chrono::milliseconds since_launch) {
+        sink = sink + since_launch.count();
+    });
+    double one_hook = time_per_iteration(record);
+    double phase_one_hook = time_per_iteration(record_phase);
+    WebViewPreLaunchMetrics::RemoveHook(hook_id);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Recording a milestone and a counter, " << kIterations << " iterations:\n"
+              << "  no hooks   " << std::setw(8) << no_hooks - baseline << " ns\n"
+              << "  one hook   " << std::setw(8) << one_hook - baseline << " ns\n"
+              << "Recording a phase duration, " << kIterations << " iterations:\n"
+              << "  no hooks   " << std::setw(8) << phase_no_hooks - baseline << " ns\n"
+              << "  one hook   " << std::setw(8) << phase_one_hook - baseline << " ns\n";
+    return 0;
+}
+
+// Time each args source takes to produce the args, as the launch records in read_args_duration.
+// The file is in the OS cache after the first read, so this is the parse and copy cost rather than
+// the disk's.
+int ArgsSourcesBenchmark(const BenchmarkOptions& benchmark_options) {
+    constexpr size_t kReadsPerRun = 100;
+    auto cached_args = WebViewJsonFileArgsSource(benchmark_options.cache_args_path).Read();
+    const std::vector<std::shared_ptr<WebViewArgsSource>> args_sources = {
+        std::make_shared<WebViewInMemoryArgsSource>(cached_args),
+        std::make_shared<WebViewJsonFileArgsSource>(benchmark_options.cache_args_path),
+        std::make_shared<WebViewMappedFileArgsSource>(benchmark_options.cache_args_path),
+    };
+
+    std::cout << "Reading the args, " << benchmark_options.runs * kReadsPerRun << " reads per source:\n";
+    for (const auto& args_source : args_sources) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t read = 0; read < benchmark_options.runs * kReadsPerRun; ++read) {
+            if (args_source->Read() != cached_args) {
+                std::cerr << args_source->GetName() << " read different args" << std::endl;
+                return 1;
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "  " << std::left << std::setw(12) << args_source->GetName() << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << elapsed / (benchmark_options.runs * kReadsPerRun) << " us\n";
+    }
+    return 0;
+}
+
+// Host exit latency, from Close until the controller is released, with each close mode.  Joining
+// without waiting for the browser is the baseline; joining while waiting for it adds the browser's
+// exit to the host's, which the detached teardown takes back off.  Detached teardowns are let
+// finish outside the timed region so they don't overlap the next run.
+int CloseModesBenchmark(const BenchmarkOptions& benchmark_options) {
+    struct CloseMode {
+        const char* name;
+        WebViewCloseMode close_mode;
+        bool wait_for_browser_process_exit;
+    };
+    constexpr CloseMode kCloseModes[] = {
+        {"join", WebViewCloseMode::kJoin, false},
+        {"join, browser exit", WebViewCloseMode::kJoin, true},
+        {"detach, browser exit", WebViewCloseMode::kDetach, true},
+    };
+    // The stand-in's browser takes about as long to exit as a real one with a few renderers.
+    WebViewStandInBackendOptions stand_in_options;
+    stand_in_options.browser_exit_latency = std::chrono::milliseconds(200);
+
+    std::map<std::string, std::vector<std::chrono::milliseconds>> host_exit;
+    for (size_t run = 0; run < benchmark_options.runs; ++run) {
+        for (const auto& mode : kCloseModes) {
+            WebViewPreLaunchOptions options;
+            options.close_mode = mode.close_mode;
+
+            auto controller = CreateController(benchmark_options, stand_in_options);
+            controller->Launch(benchmark_options.cache_args_path, options);
+            controller->WaitForLaunch();
+            if (!controller->GetTelemetry().exceptions.empty()) {
+                std::cerr << "Launch failed: " << controller->GetTelemetry().exceptions.front() << std::endl;
+                return 1;
+            }
+            std::weak_ptr<WebViewPreLaunchControllerWin> teardown = controller;
+
+            auto start = std::chrono::steady_clock::now();
+            controller->Close(mode.wait_for_browser_process_exit);
+            controller->WaitForClose();
+            controller.reset();
+            host_exit[mode.name].push_back(
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start));
+
+            while (!teardown.expired()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    std::cout << "Time from Close until the controller is released, " << benchmark_options.runs << " runs per mode:\n";
+    for (const auto& mode : kCloseModes) {
+        PrintSamples(mode.name, host_exit[mode.name]);
+    }
+    return 0;
+}
+
+const std::map<std::string, std::function<int(const BenchmarkOptions&)>> kBenchmarks = {
+    {"args_sources", ArgsSourcesBenchmark},
+    {"close_modes", CloseModesBenchmark},
+    {"launch_phases", LaunchPhasesBenchmark},
+    {"metrics_overhead", MetricsOverheadBenchmark},
+};
+
+void PrintUsage() {
+    std::cerr << "Usage: webview_prelaunch_benchmark_win [--runs N] [--stand-in] [benchmark]...\n"
+                 "Benchmarks:";
+    for (const auto& [name, benchmark] : kBenchmarks) {
+        std::cerr << " " << name;
+    }
+    std::cerr << "\nRuns every benchmark when none is named.\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions benchmark_options;
+    std::vector<std::string> benchmark_names;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--runs" && i + 1 < argc) {
+            benchmark_options.runs = std::stoul(argv[++i]);
+        } else if (arg == "--stand-in") {
+            benchmark_options.stand_in = true;
+        } else if (kBenchmarks.contains(arg)) {
+            benchmark_names.push_back(arg);
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (benchmark_names.empty()) {
+        for (const auto& [name, benchmark] : kBenchmarks) {
+            benchmark_names.push_back(name);
+        }
+    }
+
+    // Every run launches from the same args and user data dir, as a host would from one start to
+    // the next.
+    auto temp_path = std::filesystem::temp_directory_path() / "webviewprelaunch_benchmark";
+    std::filesystem::create_directories(temp_path / "user_data");
+    benchmark_options.cache_args_path = temp_path / "cache.json";
+    {
+        std::ofstream cache_file(benchmark_options.cache_args_path);
+        cache_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+        WebViewCreationArguments args;
+        args.user_data_dir = (temp_path / "user_data").string();
+        args.language = "en-US";
+        args.release_channels_mask = 0xf;
+        WebViewPreLaunchControllerWin::CacheWebViewCreationArguments(cache_file, args);
+    }
+
+    int result = 0;
+    for (const auto& name : benchmark_names) {
+        std::cout << "== " << name << (benchmark_options.stand_in ? " (stand-in)" : "") << "\n";
+        result |= kBenchmarks.at(name)(benchmark_options);
+    }
+    return result;
+}
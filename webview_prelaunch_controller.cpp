@@ -4,4 +4,137 @@
 std::chrono::milliseconds WebViewPreLaunchTelemetry::DurationSinceLaunch() const {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::high_resolution_clock::now() - launch_start);
-}
\ No newline at end of file
+}
+
+std::string DescribeLaunchStrategy(const WebViewLaunchStrategyOptions& strategy) {
+    switch (strategy.strategy) {
+        case WebViewLaunchStrategy::kImmediate:
+            return "immediate";
+        case WebViewLaunchStrategy::kDelayed:
+            return "delayed(" + std::to_string(strategy.delay.count()) + "ms)";
+        case WebViewLaunchStrategy::kOnMilestone:
+            return "milestone(" + strategy.milestone + ")";
+        case WebViewLaunchStrategy::kOnForegroundIdle:
+            return "foreground_idle";
+    }
+    return "unknown";
+}
+
+namespace {
+void ToJson(nlohmann::json& j, const char* key, std::chrono::milliseconds value) {
+    j[key] = value.count();
+}
+
+void FromJson(const nlohmann::json& j, const char* key, std::chrono::milliseconds& value) {
+    value = std::chrono::milliseconds(j.value(key, int64_t{0}));
+}
+}  // namespace
+
+void to_json(nlohmann::json& j, const WebViewWarmUpTiming& timing) {
+    j = nlohmann::json{
+        {"url", timing.url},
+        {"started", timing.started.count()},
+        {"duration", timing.duration.count()},
+        {"succeeded", timing.succeeded},
+        {"timed_out", timing.timed_out}
+    };
+}
+
+void from_json(const nlohmann::json& j, WebViewWarmUpTiming& timing) {
+    timing.url = j.value("url", std::string());
+    FromJson(j, "started", timing.started);
+    FromJson(j, "duration", timing.duration);
+    timing.succeeded = j.value("succeeded", false);
+    timing.timed_out = j.value("timed_out", false);
+}
+
+void to_json(nlohmann::json& j, const WebViewLaunchPhaseTiming& timing) {
+    j = nlohmann::json{
+        {"name", timing.name},
+        {"dependencies", timing.dependencies},
+        {"on_worker_thread", timing.on_worker_thread},
+        {"started", timing.started.count()},
+        {"completed", timing.completed.count()}
+    };
+}
+
+void from_json(const nlohmann::json& j, WebViewLaunchPhaseTiming& timing) {
+    timing.name = j.value("name", std::string());
+    timing.dependencies = j.value("dependencies", std::vector<std::string>());
+    timing.on_worker_thread = j.value("on_worker_thread", false);
+    FromJson(j, "started", timing.started);
+    FromJson(j, "completed", timing.completed);
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchTelemetry& telemetry) {
+    j = nlohmann::json::object();
+    j["exceptions"] = telemetry.exceptions;
+    ToJson(j, "background_launch_started", telemetry.background_launch_started);
+    j["launch_strategy"] = telemetry.launch_strategy;
+    j["launch_trigger"] = telemetry.launch_trigger;
+    ToJson(j, "launch_triggered", telemetry.launch_triggered);
+    j["args_source"] = telemetry.args_source;
+    j["read_args_duration_us"] = telemetry.read_args_duration.count();
+    ToJson(j, "read_cached_args_completed", telemetry.read_cached_args_completed);
+    ToJson(j, "window_created", telemetry.window_created);
+    ToJson(j, "environment_created", telemetry.environment_created);
+    ToJson(j, "controller_created", telemetry.controller_created);
+    ToJson(j, "ready", telemetry.ready);
+    ToJson(j, "adopt_completed", telemetry.adopt_completed);
+    ToJson(j, "warm_up_completed", telemetry.warm_up_completed);
+    j["warm_up"] = telemetry.warm_up;
+    j["launch_phases"] = telemetry.launch_phases;
+    j["cache_miss_reason"] = telemetry.cache_miss_reason;
+    j["args_match"] = telemetry.args_match;
+    j["runtime_version"] = telemetry.runtime_version;
+    j["runtime_prefetch_bytes"] = telemetry.runtime_prefetch_bytes;
+    ToJson(j, "waitforlaunch_started", telemetry.waitforlaunch_started);
+    ToJson(j, "waitforlaunch_completed", telemetry.waitforlaunch_completed);
+    ToJson(j, "cache_arguments_completed", telemetry.cache_arguments_completed);
+    ToJson(j, "foreground_read_cached_args_completed", telemetry.foreground_read_cached_args_completed);
+    ToJson(j, "close_started", telemetry.close_started);
+    ToJson(j, "waitforclose_completed", telemetry.waitforclose_completed);
+    j["controller_pool_hits"] = telemetry.controller_pool_hits;
+    j["controller_pool_misses"] = telemetry.controller_pool_misses;
+
+    auto& refill_latencies = j["controller_pool_refill_latencies"] = nlohmann::json::array();
+    for (const auto& refill_latency : telemetry.controller_pool_refill_latencies) {
+        refill_latencies.push_back(refill_latency.count());
+    }
+}
+
+void from_json(const nlohmann::json& j, WebViewPreLaunchTelemetry& telemetry) {
+    telemetry.exceptions = j.value("exceptions", std::vector<std::string>());
+    FromJson(j, "background_launch_started", telemetry.background_launch_started);
+    telemetry.launch_strategy = j.value("launch_strategy", std::string());
+    telemetry.launch_trigger = j.value("launch_trigger", std::string());
+    FromJson(j, "launch_triggered", telemetry.launch_triggered);
+    telemetry.args_source = j.value("args_source", std::string());
+    telemetry.read_args_duration = std::chrono::microseconds(j.value("read_args_duration_us", int64_t{0}));
+    FromJson(j, "read_cached_args_completed", telemetry.read_cached_args_completed);
+    FromJson(j, "window_created", telemetry.window_created);
+    FromJson(j, "environment_created", telemetry.environment_created);
+    FromJson(j, "controller_created", telemetry.controller_created);
+    FromJson(j, "ready", telemetry.ready);
+    FromJson(j, "adopt_completed", telemetry.adopt_completed);
+    FromJson(j, "warm_up_completed", telemetry.warm_up_completed);
+    telemetry.warm_up = j.value("warm_up", std::vector<WebViewWarmUpTiming>());
+    telemetry.launch_phases = j.value("launch_phases", std::vector<WebViewLaunchPhaseTiming>());
+    telemetry.cache_miss_reason = j.value("cache_miss_reason", std::string());
+    telemetry.args_match = j.value("args_match", std::string());
+    telemetry.runtime_version = j.value("runtime_version", std::string());
+    telemetry.runtime_prefetch_bytes = j.value("runtime_prefetch_bytes", uint64_t{0});
+    FromJson(j, "waitforlaunch_started", telemetry.waitforlaunch_started);
+    FromJson(j, "waitforlaunch_completed", telemetry.waitforlaunch_completed);
+    FromJson(j, "cache_arguments_completed", telemetry.cache_arguments_completed);
+    FromJson(j, "foreground_read_cached_args_completed", telemetry.foreground_read_cached_args_completed);
+    FromJson(j, "close_started", telemetry.close_started);
+    FromJson(j, "waitforclose_completed", telemetry.waitforclose_completed);
+    telemetry.controller_pool_hits = j.value("controller_pool_hits", uint32_t{0});
+    telemetry.controller_pool_misses = j.value("controller_pool_misses", uint32_t{0});
+
+    telemetry.controller_pool_refill_latencies.clear();
+    for (int64_t refill_latency : j.value("controller_pool_refill_latencies", std::vector<int64_t>())) {
+        telemetry.controller_pool_refill_latencies.emplace_back(refill_latency);
+    }
+}
@@ -1,13 +1,38 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "webview_args_source.hpp"
 #include "webview_creation_arguments.hpp"
 
+struct WebViewWarmUpTiming {
+  std::string url;
+  // Distance from launch_start until the navigation started.
+  std::chrono::milliseconds started = std::chrono::milliseconds::zero();
+  std::chrono::milliseconds duration = std::chrono::milliseconds::zero();
+  bool succeeded = false;
+  // The navigation ran over its budget and was stopped.
+  bool timed_out = false;
+};
+
+// One phase of the background launch, up to requesting the environment.
+struct WebViewLaunchPhaseTiming {
+  std::string name;
+  // Phases that had to complete before this one started.
+  std::vector<std::string> dependencies;
+  // Ran on the worker thread rather than the launch thread.
+  bool on_worker_thread = false;
+  // Distances from launch_start.
+  std::chrono::milliseconds started = std::chrono::milliseconds::zero();
+  std::chrono::milliseconds completed = std::chrono::milliseconds::zero();
+};
+
 struct WebViewPreLaunchTelemetry {
   std::vector<std::string> exceptions;
 
@@ -15,10 +40,42 @@ struct WebViewPreLaunchTelemetry {
   // All the subsequent milliseconds record the distance from launch_start until their recording.
   // They are not step times to be summed.  Zero values were not recorded.
   std::chrono::milliseconds background_launch_started = std::chrono::milliseconds::zero();
+  // The launch strategy used, as described by DescribeLaunchStrategy, and what started the launch:
+  // "immediate", "delay_elapsed", "milestone", "foreground_idle", "max_deferral" or "closed" when
+  // the controller was closed before the launch started.
+  std::string launch_strategy;
+  std::string launch_trigger;
+  std::chrono::milliseconds launch_triggered = std::chrono::milliseconds::zero();
+  // The WebViewArgsSource the args were read from, by name, and how long reading them took.  In
+  // microseconds, as in-memory args take well under a millisecond.
+  std::string args_source;
+  std::chrono::microseconds read_args_duration = std::chrono::microseconds::zero();
   std::chrono::milliseconds read_cached_args_completed = std::chrono::milliseconds::zero();
   std::chrono::milliseconds window_created = std::chrono::milliseconds::zero();
   std::chrono::milliseconds environment_created = std::chrono::milliseconds::zero();
   std::chrono::milliseconds controller_created = std::chrono::milliseconds::zero();
+  // When WaitForLaunch was released with the launch ready: once the controller pool was filled
+  // and, with warm_up.before_ready, warm-up finished.  Not recorded for failed launches.
+  std::chrono::milliseconds ready = std::chrono::milliseconds::zero();
+  std::chrono::milliseconds adopt_completed = std::chrono::milliseconds::zero();
+  std::chrono::milliseconds warm_up_completed = std::chrono::milliseconds::zero();
+  std::vector<WebViewWarmUpTiming> warm_up;
+  // The launch phases that ran, in the order they were declared.
+  std::vector<WebViewLaunchPhaseTiming> launch_phases;
+  // Why the launch couldn't count on the runtime's files being warm: "runtime_changed" when the
+  // runtime was updated since the last launch from the same cached args, "runtime_unknown" when
+  // no runtime was recorded for them yet or the runtime couldn't be resolved.  Empty when the
+  // runtime was the same, and for args sources without a cache file, which don't record it.
+  std::string cache_miss_reason;
+  // "hit" when the host found its args equal to the ones the pre-launch ran with, "miss" when they
+  // differed.  Empty until the host checked with MatchesPreLaunchArgs.
+  std::string args_match;
+  // The version of the runtime the launch resolved to.  Resolved next to the launch rather than
+  // ahead of it, so like cache_miss_reason and runtime_prefetch_bytes it may only be set once
+  // WaitForClose returned.
+  std::string runtime_version;
+  // Bytes of an updated runtime's files read while the browser started.
+  uint64_t runtime_prefetch_bytes = 0;
   // The timings from here forward are recorded on the foreground thread to help track any negative
   // impact on its execution from pre-launching.
   std::chrono::milliseconds waitforlaunch_started = std::chrono::milliseconds::zero();
@@ -29,23 +86,134 @@ struct WebViewPreLaunchTelemetry {
   std::chrono::milliseconds close_started = std::chrono::milliseconds::zero();
   std::chrono::milliseconds waitforclose_completed = std::chrono::milliseconds::zero();
 
+  // Controller pool accounting.  A hit is a host taking a pre-created controller, a miss is a
+  // request for a profile whose pool was empty or never configured.
+  uint32_t controller_pool_hits = 0;
+  uint32_t controller_pool_misses = 0;
+  // Time from a pooled controller being handed out until its background replacement was ready.
+  std::vector<std::chrono::milliseconds> controller_pool_refill_latencies;
+
   std::chrono::milliseconds DurationSinceLaunch() const;
 };
 
+// Serializes the millisecond offsets, counters and exceptions.  launch_start is process local and
+// is not serialized, so it is left untouched by from_json.  Missing fields read as not recorded.
+void to_json(nlohmann::json& j, const WebViewPreLaunchTelemetry& telemetry);
+void from_json(const nlohmann::json& j, WebViewPreLaunchTelemetry& telemetry);
+void to_json(nlohmann::json& j, const WebViewWarmUpTiming& timing);
+void from_json(const nlohmann::json& j, WebViewWarmUpTiming& timing);
+void to_json(nlohmann::json& j, const WebViewLaunchPhaseTiming& timing);
+void from_json(const nlohmann::json& j, WebViewLaunchPhaseTiming& timing);
+
+// Controllers pre-created on the pre-launched browser tree so that hosts opening several panes,
+// possibly in different profiles, don't pay controller creation for each of them.
+struct WebViewControllerPoolOptions {
+  // Number of ready controllers kept per profile.  Zero disables the pool.
+  size_t controllers_per_profile = 0;
+  // Profiles to keep controllers for.  The empty name is the default profile.
+  std::vector<std::string> profile_names = {""};
+};
+
+// Pages the pre-launched webview loads in the background so that the host's first navigation
+// finds DNS, TLS, the HTTP cache and the JS code cache already warm.
+struct WebViewWarmUpOptions {
+  // Loaded in order, one at a time.  file:/// URLs work for local pages.
+  std::vector<std::string> urls;
+  // Optional file listing more URLs, one per line, loaded after |urls|.
+  std::filesystem::path urls_file;
+  // A navigation still running after its budget is stopped and the next URL started.
+  std::chrono::milliseconds per_url_budget = std::chrono::milliseconds(5000);
+  // Whether WaitForLaunch waits for warm-up.  Otherwise warm-up starts right after the launch is
+  // reported ready.
+  bool before_ready = false;
+};
+
+enum class WebViewLaunchStrategy {
+  // Starts the launch right away.
+  kImmediate,
+  // Starts the launch |delay| after Launch.
+  kDelayed,
+  // Starts the launch once the host calls SignalMilestone with |milestone|.
+  kOnMilestone,
+  // Starts the launch once the thread that called Launch is the foreground thread and about to go
+  // idle, meaning the host has worked through its startup messages.
+  kOnForegroundIdle,
+};
+
+// When the background launch starts, so that on machines where the pre-launch competes with the
+// host's own startup work (splash, config load) it can hold back until that work is done.
+struct WebViewLaunchStrategyOptions {
+  WebViewLaunchStrategy strategy = WebViewLaunchStrategy::kImmediate;
+  std::chrono::milliseconds delay = std::chrono::milliseconds::zero();
+  std::string milestone;
+  // Milestone and foreground idle launches start after this much time regardless, so a host that
+  // never signals, or never goes idle in the foreground, still gets a pre-launch.
+  std::chrono::milliseconds max_deferral = std::chrono::milliseconds(10000);
+};
+
+// A short description of |strategy| including its parameters, e.g. "delayed(500ms)".  Recorded in
+// telemetry so runs can be grouped by strategy.
+std::string DescribeLaunchStrategy(const WebViewLaunchStrategyOptions& strategy);
+
+// How Close tears the pre-launch down.
+enum class WebViewCloseMode {
+  // WaitForClose, and the destructor, wait for the launch thread to finish, including for the
+  // browser process to exit when Close was asked to wait for it.
+  kJoin,
+  // Close hands the teardown to a detached thread that keeps the controller alive until the
+  // teardown is done, so hosts can exit without waiting on the browser process.  WaitForClose
+  // returns once the telemetry is final, before the browser process exited; errors after that are
+  // only recorded in the metrics.  Requires the controller to be owned by a std::shared_ptr; the
+  // destructor still joins.  Exiting the process while the teardown runs is only safe as far as
+  // this library's own statics go, the metrics and the environment options cache, which are never
+  // destroyed.  Statics of the stand-in backend, nlohmann/json, WIL and the WebView2 loader aren't
+  // covered, so hosts that can should still let the teardown finish.
+  kDetach,
+};
+
+struct WebViewPreLaunchOptions {
+  WebViewControllerPoolOptions controller_pool;
+  WebViewWarmUpOptions warm_up;
+  // Whether the launch phases that don't depend on each other run concurrently, for instance
+  // reading the cached args while the launch thread sets up its apartment and window.  Turning it
+  // off runs them in sequence, which is only useful to measure what the overlap saves.
+  bool overlap_launch_phases = true;
+  WebViewLaunchStrategyOptions launch_strategy;
+  // A/B mode.  When not empty, each launch picks one of these strategies at random in place of
+  // |launch_strategy|; the one picked is recorded in telemetry.
+  std::vector<WebViewLaunchStrategyOptions> launch_strategy_candidates;
+  // Whether a launch finding the runtime updated since the last launch reads the new runtime's
+  // files while the browser starts, rather than leaving the browser to page them in cold.
+  bool prefetch_updated_runtime = true;
+  WebViewCloseMode close_mode = WebViewCloseMode::kJoin;
+  // The instant telemetry offsets and launch deadlines count from, when not the call to Launch.
+  // Trees launched together share one so that their offsets compare.
+  std::optional<std::chrono::time_point<std::chrono::high_resolution_clock>> launch_start;
+};
+
 class WebViewPreLaunchController {
 public:
   virtual ~WebViewPreLaunchController() = default;
   
   // Starts webview launch on a background thread.
   static std::shared_ptr<WebViewPreLaunchController> Launch(
-    const std::filesystem::path& cache_args_path);
+    const std::filesystem::path& cache_args_path,
+    const WebViewPreLaunchOptions& options = {});
+  // Starts webview launch with args the host already has, without reading any file for them.
+  static std::shared_ptr<WebViewPreLaunchController> Launch(
+    const WebViewCreationArguments& args,
+    const WebViewPreLaunchOptions& options = {});
+  static std::shared_ptr<WebViewPreLaunchController> Launch(
+    std::shared_ptr<WebViewArgsSource> args_source,
+    const WebViewPreLaunchOptions& options = {});
 
   virtual const std::optional<WebViewCreationArguments>& ReadCachedWebViewCreationArguments(
     const std::filesystem::path& cache_args_path) noexcept = 0;
   virtual void CacheWebViewCreationArguments(const std::filesystem::path& cache_args_path,
                                              const WebViewCreationArguments& args) noexcept = 0;
 
-  // Closes the pre-launched webview and exits the background thread.
+  // Closes the pre-launched webview and exits the background thread.  Only the first call counts;
+  // later ones return right away.
   virtual void Close(bool close_webview_on_exit) = 0;
   // Blocks while closing activities are completed.
   virtual void WaitForClose() = 0;
@@ -53,7 +221,16 @@ public:
   // Blocks until launch is completed.
   virtual void WaitForLaunch() = 0;
 
+  // Whether |args| are the ones the pre-launch ran with, so that the host can use the pre-launched
+  // tree rather than close it.  Records the outcome as a hit or a miss.  Call after WaitForLaunch.
+  virtual bool MatchesPreLaunchArgs(const WebViewCreationArguments& args) = 0;
+
+  // Tells a launch using the kOnMilestone strategy that the host reached |milestone|.  Other
+  // milestones and strategies ignore it.
+  virtual void SignalMilestone(const std::string& milestone) = 0;
+
   // Get telemetry data about the pre-launch process.
-  // This should be called after WaitForLaunch() to get accurate data.
+  // This should be called after WaitForLaunch() to get accurate data.  WebViewPreLaunchMetrics
+  // reports events as they happen.
   virtual const WebViewPreLaunchTelemetry& GetTelemetry() const = 0;
 };
\ No newline at end of file
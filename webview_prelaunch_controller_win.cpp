@@ -1,17 +1,39 @@
 #include "webview_prelaunch_controller_win.hpp"
 
-#include <boost/nowide/convert.hpp>
+#include <algorithm>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "webview_launch_graph.hpp"
+#include "webview_prelaunch_metrics.hpp"
 
 using json = nlohmann::json;
 
 /* static */
-std::shared_ptr<WebViewPreLaunchController> WebViewPreLaunchController::Launch(const std::filesystem::path& cache_args_path) {
+std::shared_ptr<WebViewPreLaunchController> WebViewPreLaunchController::Launch(const std::filesystem::path& cache_args_path, const WebViewPreLaunchOptions& options) {
+    auto webview_prelaunch = std::make_shared<WebViewPreLaunchControllerWin>();
+    webview_prelaunch->Launch(cache_args_path, options);
+    return webview_prelaunch;
+}
+
+/* static */
+std::shared_ptr<WebViewPreLaunchController> WebViewPreLaunchController::Launch(const WebViewCreationArguments& args, const WebViewPreLaunchOptions& options) {
+    auto webview_prelaunch = std::make_shared<WebViewPreLaunchControllerWin>();
+    webview_prelaunch->Launch(args, options);
+    return webview_prelaunch;
+}
+
+/* static */
+std::shared_ptr<WebViewPreLaunchController> WebViewPreLaunchController::Launch(std::shared_ptr<WebViewArgsSource> args_source, const WebViewPreLaunchOptions& options) {
     auto webview_prelaunch = std::make_shared<WebViewPreLaunchControllerWin>();
-    webview_prelaunch->Launch(cache_args_path);
+    webview_prelaunch->Launch(std::move(args_source), options);
     return webview_prelaunch;
 }
 
@@ -25,6 +47,7 @@ void HandleException(const std::exception_ptr& ex, WebViewPreLaunchTelemetry& te
     } catch (...) {
         telemetry.exceptions.push_back(unknown_exception_msg);
     }
+    WebViewPreLaunchMetrics::RecordError(telemetry.exceptions.back());
 }
 
 // Minimal Window Procedure function to facilitate WebView2 creation
@@ -38,10 +61,61 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     }
 }
 
-WebViewPreLaunchControllerWin::WebViewPreLaunchControllerWin() : semaphore_(0) {}
+// Holds a deferred launch back until the first of its triggers fires.  Shared with the foreground
+// idle hook, which can outlive the controller.
+class WebViewLaunchTrigger {
+public:
+    void Fire(const char* reason) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (reason_.empty()) {
+                reason_ = reason;
+            }
+        }
+        fired_.notify_all();
+    }
+
+    // Fires with |timeout_reason| unless fired within |timeout|, and returns the reason it fired.
+    std::string Wait(std::chrono::milliseconds timeout, const char* timeout_reason) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!fired_.wait_for(lock, timeout, [this]() { return !reason_.empty(); })) {
+            reason_ = timeout_reason;
+        }
+        return reason_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable fired_;
+    std::string reason_;
+};
+
+namespace {
+// Triggers waiting for their host thread to go idle in the foreground.  WH_FOREGROUNDIDLE hooks call
+// back on the thread they were installed for, so this is kept per thread.
+thread_local HHOOK foreground_idle_hook = nullptr;
+thread_local std::vector<std::weak_ptr<WebViewLaunchTrigger>> foreground_idle_triggers;
+
+LRESULT CALLBACK ForegroundIdleProc(int code, WPARAM wParam, LPARAM lParam) {
+    HHOOK hook = foreground_idle_hook;
+    if (code == HC_ACTION) {
+        for (const auto& weak_trigger : std::exchange(foreground_idle_triggers, {})) {
+            if (auto trigger = weak_trigger.lock()) {
+                trigger->Fire("foreground_idle");
+            }
+        }
+        UnhookWindowsHookEx(hook);
+        foreground_idle_hook = nullptr;
+    }
+    return CallNextHookEx(hook, code, wParam, lParam);
+}
+}  // namespace
+
+WebViewPreLaunchControllerWin::WebViewPreLaunchControllerWin(std::shared_ptr<WebViewBackend> backend)
+    : backend_(std::move(backend)), semaphore_(0), launch_trigger_(std::make_shared<WebViewLaunchTrigger>()) {}
 
 WebViewPreLaunchControllerWin::~WebViewPreLaunchControllerWin() {
-    if (launch_thread_.joinable()) {
+    if (!teardown_detached_ && launch_thread_.joinable()) {
         Close(/*wait_for_browser_process_exit*/false);
         WaitForClose();
     }
@@ -97,101 +171,316 @@ public:
 private:
     T& t;
 };
+
+// Thread message carrying a heap allocated std::function<void()> in its LPARAM.  Posted to the
+// thread rather than the window so that tasks survive the window being destroyed during close.
+constexpr UINT kRunTaskMessage = WM_APP + 1;
+
+void RunPostedTask(const MSG& msg) {
+    std::unique_ptr<std::function<void()>> task(reinterpret_cast<std::function<void()>*>(msg.lParam));
+    (*task)();
+}
 }  // namespace
 
-void WebViewPreLaunchControllerWin::Launch(const std::filesystem::path& cache_args_path) {
-    telemetry_.launch_start = std::chrono::high_resolution_clock::now();
+void WebViewPreLaunchControllerWin::Launch(const std::filesystem::path& cache_args_path, const WebViewPreLaunchOptions& options) {
+    Launch(std::make_shared<WebViewJsonFileArgsSource>(cache_args_path), options);
+}
+
+void WebViewPreLaunchControllerWin::Launch(const WebViewCreationArguments& args, const WebViewPreLaunchOptions& options) {
+    Launch(std::make_shared<WebViewInMemoryArgsSource>(args), options);
+}
 
-    launch_thread_ = std::thread([this, cache_args_path]() {
-        this->LaunchBackground(cache_args_path);
+void WebViewPreLaunchControllerWin::Launch(std::shared_ptr<WebViewArgsSource> args_source, const WebViewPreLaunchOptions& options) {
+    telemetry_.launch_start = options.launch_start.value_or(std::chrono::high_resolution_clock::now());
+    options_ = options;
+    cache_args_path_ = args_source->GetCachePath();
+    telemetry_.args_source = args_source->GetName();
+    WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kLaunches);
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kLaunchStarted, std::chrono::milliseconds::zero());
+    ArmLaunchTrigger();
+
+    launch_thread_ = std::thread([this, args_source = std::move(args_source)]() {
+        this->LaunchBackground(args_source);
     });
 }
 
-void WebViewPreLaunchControllerWin::LaunchBackground(const std::filesystem::path& cache_args_path) noexcept {
+void WebViewPreLaunchControllerWin::LaunchBackground(std::shared_ptr<WebViewArgsSource> args_source) noexcept {
     telemetry_.background_launch_started = telemetry_.DurationSinceLaunch();
+    launch_thread_id_ = GetCurrentThreadId();
     AutoRelease<decltype(semaphore_)> auto_release_semaphore(semaphore_);
 
     try {
-        AutoReset<decltype(webview_)> auto_reset_webview(webview_);
+        AutoReset<decltype(environment_)> auto_reset_environment(environment_);
         AutoReset<decltype(webviewController_)> auto_reset_webview_controller(webviewController_);
 
-        std::ifstream cache_file(cache_args_path);
-        cache_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        auto args = ReadCachedWebViewCreationArguments(cache_file);
-        telemetry_.read_cached_args_completed = telemetry_.DurationSinceLaunch();
-
-        THROW_IF_FAILED(RoInitialize(RO_INIT_SINGLETHREADED));
-        backgroundHwnd_ = CreateMessageWindow();
-        telemetry_.window_created = telemetry_.DurationSinceLaunch();
-        
-        // Initialize WebView2
-        auto options = Microsoft::WRL::Make<CoreWebView2EnvironmentOptions>();
-        THROW_IF_NULL_ALLOC(options);
-        THROW_IF_FAILED(options->put_AllowSingleSignOnUsingOSPrimaryAccount(true));
-
-        Microsoft::WRL::ComPtr<ICoreWebView2EnvironmentOptions7> options7;
-        options.As(&options7);
-        THROW_IF_NULL_ALLOC(options7);
-        THROW_IF_FAILED(options7->put_ChannelSearchKind(static_cast<COREWEBVIEW2_CHANNEL_SEARCH_KIND>(args.channel_search_kind)));
-        THROW_IF_FAILED(options7->put_ReleaseChannels(static_cast<COREWEBVIEW2_RELEASE_CHANNELS>(args.release_channels_mask)));
-        
-        std::wstring browser_exe_path = boost::nowide::widen(args.browser_exe_path);
-        std::wstring user_data_dir = boost::nowide::widen(args.user_data_dir);
-        std::wstring additional_browser_arguments = boost::nowide::widen(args.additional_browser_arguments);
-        std::wstring language = boost::nowide::widen(args.language);
-
-        THROW_IF_FAILED(options->put_AdditionalBrowserArguments(additional_browser_arguments.c_str()));
-        THROW_IF_FAILED(options->put_EnableTrackingPrevention(args.enable_tracking_prevention));
-        THROW_IF_FAILED(options->put_Language(language.c_str()));
-
-        HRESULT hr = CreateCoreWebView2EnvironmentWithOptions(      
-            browser_exe_path.c_str(), 
-            user_data_dir.c_str(),
-            options.Get(),
-            Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
-                [this](HRESULT result, ICoreWebView2Environment* env) -> HRESULT {
-                    return EnvironmentCreatedCallback(result, env);
-                }).Get());
-        THROW_IF_FAILED(hr);
+        if (!WaitForLaunchTrigger()) {
+            SettleTelemetry();
+            return;
+        }
+
+        // Only the environment needs the args, so reading them overlaps with setting up the launch
+        // thread's apartment and window.  Args read without I/O aren't worth starting a worker for.
+        WebViewCreationArguments args;
+        WebViewLaunchGraph launch_graph;
+        bool read_args_off_launch_thread = args_source->ReadDoesIo();
+        launch_graph.AddPhase("read_cached_args", {}, read_args_off_launch_thread, [this, &args, &args_source]() {
+            auto read_started = std::chrono::high_resolution_clock::now();
+            args = args_source->Read();
+            telemetry_.read_args_duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - read_started);
+            telemetry_.read_cached_args_completed = telemetry_.DurationSinceLaunch();
+            WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kCachedArgsRead, telemetry_.read_cached_args_completed);
+        });
+        launch_graph.AddPhase("build_options", {"read_cached_args"}, read_args_off_launch_thread, [this, &args]() {
+            environment_options_ = WebViewEnvironmentOptions::Get(args);
+        });
+        launch_graph.AddPhase("init_apartment", {}, /*off_launch_thread*/false, []() {
+            THROW_IF_FAILED(RoInitialize(RO_INIT_SINGLETHREADED));
+        });
+        launch_graph.AddPhase("create_window", {"init_apartment"}, /*off_launch_thread*/false, [this]() {
+            backgroundHwnd_ = CreateMessageWindow();
+            telemetry_.window_created = telemetry_.DurationSinceLaunch();
+            WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kWindowCreated, telemetry_.window_created);
+        });
+        launch_graph.AddPhase("request_environment", {"build_options", "create_window"}, /*off_launch_thread*/false, [this]() {
+            backend_->CreateEnvironment(environment_options_,
+                [this](HRESULT result, std::shared_ptr<WebViewBackendEnvironment> env) -> HRESULT {
+                    return EnvironmentCreatedCallback(result, std::move(env));
+                });
+            environment_requested_ = telemetry_.DurationSinceLaunch();
+        });
+        launch_graph.Run(options_.overlap_launch_phases, telemetry_);
+
+        // Resolving the runtime and prefetching an update overlap with the browser starting from it
+        // rather than holding up the message loop its callbacks arrive on.
+        runtime_thread_ = std::thread([this, browser_process = runtime_browser_process_.get_future()]() mutable {
+            RunRuntimeTasks(std::move(browser_process));
+        });
 
         // Run the message loop
         MSG msg = {};
         while (GetMessage(&msg, NULL, 0, 0)) {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
+            if (msg.hwnd == nullptr && msg.message == kRunTaskMessage) {
+                RunPostedTask(msg);
+            } else if (msg.hwnd == nullptr && msg.message == WM_TIMER) {
+                RunDelayedTask(msg.wParam);
+            } else {
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
 
             if (background_thread_should_exit_) {
                 break;
             }
         }
 
-        if (wait_for_browser_process_exit_) {
-            HANDLE browser_process_handle = ::OpenProcess(SYNCHRONIZE , false, browser_process_id_);
-            THROW_LAST_ERROR_IF_NULL(browser_process_handle);
+        // Drop tasks that arrived too late to run so their closures aren't leaked.
+        while (PeekMessage(&msg, NULL, kRunTaskMessage, kRunTaskMessage, PM_REMOVE)) {
+            delete reinterpret_cast<std::function<void()>*>(msg.lParam);
+        }
+        ClearControllerPool();
+        JoinRuntimeThread();
+        SettleTelemetry();
+
+        // An adopted tree is still in use by the host, so its browser process won't exit with us.
+        if (wait_for_browser_process_exit_ && !adopted_) {
+            auto browser_process = backend_->OpenBrowserProcess(browser_process_id_);
 
-            webview_.reset();
             webviewController_.reset();
-            WaitForSingleObject(browser_process_handle, INFINITE);
+            environment_.reset();
+            WaitForSingleObject(browser_process.get(), INFINITE);
         }    
     }
     catch(...) {
         auto ce = std::current_exception();
-        HandleException(ce, telemetry_, "Unknown exception occurred in LaunchBackground");
+        if (telemetry_settled_) {
+            // The host may be reading the telemetry already, so this only reaches the metrics.
+            WebViewPreLaunchTelemetry settled_telemetry;
+            HandleException(ce, settled_telemetry, "Unknown exception occurred in LaunchBackground");
+        } else {
+            HandleException(ce, telemetry_, "Unknown exception occurred in LaunchBackground");
+        }
+    }
+    JoinRuntimeThread();
+    SettleTelemetry();
+}
+
+void WebViewPreLaunchControllerWin::SettleTelemetry() noexcept {
+    telemetry_settled_ = true;
+    telemetry_settled_.notify_all();
+}
+
+void WebViewPreLaunchControllerWin::RunRuntimeTasks(std::future<uint32_t> browser_process) noexcept try {
+    auto updated_runtime_dir = ResolveRuntime();
+    if (options_.prefetch_updated_runtime && !updated_runtime_dir.empty()) {
+        telemetry_.runtime_prefetch_bytes = PrefetchRuntimeFiles(updated_runtime_dir, runtime_tasks_stopped_);
+    }
+
+    // Recorded for the next launch to compare against once the browser process is known.  Teardown
+    // joins this thread, so a Close right after WaitForLaunch doesn't lose it.
+    auto browser_process_id = browser_process.get();
+    if (browser_process_id != 0) {
+        RecordRuntimeIdentity(browser_process_id);
+    }
+}
+catch(...) {
+    runtime_exception_ = std::current_exception();
+}
+
+void WebViewPreLaunchControllerWin::SetRuntimeBrowserProcess(uint32_t browser_process_id) noexcept {
+    if (!runtime_browser_process_set_) {
+        runtime_browser_process_set_ = true;
+        runtime_browser_process_.set_value(browser_process_id);
+    }
+}
+
+void WebViewPreLaunchControllerWin::JoinRuntimeThread() noexcept {
+    if (!runtime_thread_.joinable()) {
+        return;
+    }
+
+    // A prefetch still reading isn't worth holding up the teardown for, and without a controller
+    // there is no runtime to record.
+    runtime_tasks_stopped_ = true;
+    SetRuntimeBrowserProcess(0);
+    runtime_thread_.join();
+    if (runtime_exception_) {
+        HandleException(runtime_exception_, telemetry_, "Unknown exception occurred in RunRuntimeTasks");
+    }
+}
+
+std::filesystem::path WebViewPreLaunchControllerWin::ResolveRuntime() noexcept try {
+    telemetry_.runtime_version = backend_->GetAvailableRuntimeVersion(*environment_options_);
+    // Args sources without a cache file have nowhere to keep the runtime, so there is nothing to
+    // miss either.
+    if (cache_args_path_.empty()) {
+        return {};
+    }
+
+    stored_runtime_identity_ = ReadRuntimeIdentity(cache_args_path_);
+    if (!stored_runtime_identity_.has_value()) {
+        telemetry_.cache_miss_reason = "runtime_unknown";
+        return {};
+    }
+
+    const auto& stored = stored_runtime_identity_.value();
+    bool runtime_changed = telemetry_.runtime_version != stored.version;
+    if (!runtime_changed) {
+        try {
+            runtime_changed = GetRuntimeIdentity(stored.executable_path, stored.version) != stored;
+        }
+        catch (const std::filesystem::filesystem_error&) {
+            runtime_changed = true;
+        }
+    }
+    if (!runtime_changed) {
+        return {};
+    }
+
+    telemetry_.cache_miss_reason = "runtime_changed";
+    WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kRuntimeChanges);
+
+    // A fixed version runtime is replaced in place, while each version of the evergreen runtime is
+    // installed in a folder of its own next to the previous one's.
+    const auto& browser_exe_path = environment_options_->GetBrowserExePath();
+    if (!browser_exe_path.empty()) {
+        return browser_exe_path;
+    }
+    return stored.executable_path.parent_path().parent_path() / telemetry_.runtime_version;
+}
+catch(...) {
+    // Not a launch failure: without a runtime, creating the environment fails and reports why.
+    if (!cache_args_path_.empty()) {
+        telemetry_.cache_miss_reason = "runtime_unknown";
+    }
+    return {};
+}
+
+void WebViewPreLaunchControllerWin::RecordRuntimeIdentity(uint32_t browser_process_id) {
+    if (cache_args_path_.empty() || telemetry_.runtime_version.empty()) {
+        return;
+    }
+    auto executable_path = backend_->GetBrowserExecutablePath(browser_process_id);
+    if (executable_path.empty()) {
+        return;
+    }
+
+    auto identity = GetRuntimeIdentity(executable_path, telemetry_.runtime_version);
+    if (stored_runtime_identity_ != identity) {
+        WriteRuntimeIdentity(cache_args_path_, identity);
+        stored_runtime_identity_ = identity;
+    }
+}
+
+void WebViewPreLaunchControllerWin::ArmLaunchTrigger() {
+    launch_strategy_ = options_.launch_strategy;
+    if (!options_.launch_strategy_candidates.empty()) {
+        std::random_device random_device;
+        std::uniform_int_distribution<size_t> candidate(0, options_.launch_strategy_candidates.size() - 1);
+        launch_strategy_ = options_.launch_strategy_candidates[candidate(random_device)];
+    }
+    telemetry_.launch_strategy = DescribeLaunchStrategy(launch_strategy_);
+
+    switch (launch_strategy_.strategy) {
+        case WebViewLaunchStrategy::kImmediate:
+            launch_trigger_->Fire("immediate");
+            break;
+        case WebViewLaunchStrategy::kOnForegroundIdle:
+            // Launch runs on the host's thread, which is the one to watch.
+            foreground_idle_triggers.push_back(launch_trigger_);
+            if (foreground_idle_hook == nullptr) {
+                foreground_idle_hook = SetWindowsHookEx(WH_FOREGROUNDIDLE, ForegroundIdleProc, nullptr, GetCurrentThreadId());
+                if (foreground_idle_hook == nullptr) {
+                    // Without the hook there is no idle to wait for.
+                    foreground_idle_triggers.clear();
+                    launch_trigger_->Fire("immediate");
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool WebViewPreLaunchControllerWin::WaitForLaunchTrigger() {
+    auto timeout = launch_strategy_.strategy == WebViewLaunchStrategy::kDelayed ? launch_strategy_.delay : launch_strategy_.max_deferral;
+    auto timeout_reason = launch_strategy_.strategy == WebViewLaunchStrategy::kDelayed ? "delay_elapsed" : "max_deferral";
+
+    // Deadlines count from Launch rather than from the thread starting.
+    auto elapsed = telemetry_.DurationSinceLaunch();
+    telemetry_.launch_trigger = launch_trigger_->Wait(std::max(timeout - elapsed, std::chrono::milliseconds::zero()), timeout_reason);
+    telemetry_.launch_triggered = telemetry_.DurationSinceLaunch();
+    if (telemetry_.launch_trigger == "closed") {
+        return false;
+    }
+
+    if (telemetry_.launch_trigger == "max_deferral") {
+        WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kLaunchDeferralTimeouts);
+    }
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kLaunchTriggered, telemetry_.launch_triggered);
+    return true;
+}
+
+void WebViewPreLaunchControllerWin::SignalMilestone(const std::string& milestone) {
+    if (launch_strategy_.strategy == WebViewLaunchStrategy::kOnMilestone && milestone == launch_strategy_.milestone) {
+        launch_trigger_->Fire("milestone");
     }
 }
 
-HRESULT WebViewPreLaunchControllerWin::EnvironmentCreatedCallback(HRESULT result, ICoreWebView2Environment* env) noexcept try {
+HRESULT WebViewPreLaunchControllerWin::EnvironmentCreatedCallback(HRESULT result, std::shared_ptr<WebViewBackendEnvironment> env) noexcept try {
     telemetry_.environment_created = telemetry_.DurationSinceLaunch();
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kEnvironmentCreated, telemetry_.environment_created);
     THROW_IF_FAILED(result);
+    WebViewPreLaunchMetrics::RecordPhaseDuration(WebViewLaunchPhase::kCreateEnvironment, telemetry_.environment_created - environment_requested_);
+    environment_ = std::move(env);
 
     // Create the WebView using the default profile
-    HRESULT hr = env->CreateCoreWebView2Controller(
+    environment_->CreateController(
         backgroundHwnd_,
-        Microsoft::WRL::Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
-            [this](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT {
-                return ControllerCreatedCallback(result, controller);
-            }).Get());
-    THROW_IF_FAILED(hr);
+        /*profile_name*/"",
+        [this](HRESULT result, std::shared_ptr<WebViewBackendController> controller) -> HRESULT {
+            return ControllerCreatedCallback(result, std::move(controller));
+        });
 
     return S_OK;
 }
@@ -204,17 +493,20 @@ catch(...) {
     RETURN_CAUGHT_EXCEPTION();
 }
 
-HRESULT WebViewPreLaunchControllerWin::ControllerCreatedCallback(HRESULT result, ICoreWebView2Controller* controller) noexcept try {
+HRESULT WebViewPreLaunchControllerWin::ControllerCreatedCallback(HRESULT result, std::shared_ptr<WebViewBackendController> controller) noexcept try {
     telemetry_.controller_created = telemetry_.DurationSinceLaunch();
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kControllerCreated, telemetry_.controller_created);
     THROW_IF_FAILED(result);
+    WebViewPreLaunchMetrics::RecordPhaseDuration(WebViewLaunchPhase::kCreateController, telemetry_.controller_created - telemetry_.environment_created);
 
-    webviewController_ = controller;
-    THROW_IF_FAILED(webviewController_->get_CoreWebView2(&webview_));
-    
-    THROW_IF_FAILED(webview_->get_BrowserProcessId(&browser_process_id_));
+    webviewController_ = std::move(controller);
+    browser_process_id_ = webviewController_->GetBrowserProcessId();
+    controller_created_ = true;
     
-    // Release the semaphore to indicate that the WebView is ready
-    semaphore_.release();
+    // The semaphore is released to indicate that the WebView is ready once the pool is filled and,
+    // if requested, warm-up has finished
+    FillControllerPool();
+    SetRuntimeBrowserProcess(browser_process_id_);
     return S_OK;
 }
 catch(...) {
@@ -226,22 +518,407 @@ catch(...) {
     RETURN_CAUGHT_EXCEPTION();
 }
 
+void WebViewPreLaunchControllerWin::FillControllerPool() noexcept {
+    // Count every creation up front so an early completion can't signal readiness prematurely.
+    const auto& pool_options = options_.controller_pool;
+    pending_pool_controllers_ = pool_options.controllers_per_profile * pool_options.profile_names.size();
+    if (pending_pool_controllers_ == 0) {
+        ControllerPoolFilled();
+        return;
+    }
+
+    for (const auto& profile_name : pool_options.profile_names) {
+        for (size_t i = 0; i < pool_options.controllers_per_profile; ++i) {
+            try {
+                CreatePooledController(profile_name, /*is_refill*/false);
+            }
+            catch(...) {
+                auto ce = std::current_exception();
+                HandleException(ce, telemetry_, "Unknown exception occurred in FillControllerPool");
+                PooledControllerSettled(/*is_refill*/false);
+            }
+        }
+    }
+}
+
+void WebViewPreLaunchControllerWin::CreatePooledController(const std::string& profile_name, bool is_refill) {
+    auto requested = std::chrono::high_resolution_clock::now();
+
+    environment_->CreateController(
+        backgroundHwnd_,
+        profile_name,
+        [this, profile_name, requested, is_refill](HRESULT result, std::shared_ptr<WebViewBackendController> controller) -> HRESULT {
+            return PooledControllerCreatedCallback(result, std::move(controller), profile_name, requested, is_refill);
+        });
+}
+
+HRESULT WebViewPreLaunchControllerWin::PooledControllerCreatedCallback(
+    HRESULT result,
+    std::shared_ptr<WebViewBackendController> controller,
+    const std::string& profile_name,
+    std::chrono::time_point<std::chrono::high_resolution_clock> requested,
+    bool is_refill) noexcept try {
+    THROW_IF_FAILED(result);
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        controller_pool_[profile_name].push_back(std::move(controller));
+        if (is_refill) {
+            telemetry_.controller_pool_refill_latencies.push_back(
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - requested));
+        }
+    }
+
+    PooledControllerSettled(is_refill);
+    return S_OK;
+}
+catch(...) {
+    auto ce = std::current_exception();
+    HandleException(ce, telemetry_, "Unknown exception occurred in PooledControllerCreatedCallback");
+
+    // A pooled controller failing doesn't invalidate the pre-launched tree; hosts just see a miss.
+    PooledControllerSettled(is_refill);
+    RETURN_CAUGHT_EXCEPTION();
+}
+
+void WebViewPreLaunchControllerWin::PooledControllerSettled(bool is_refill) noexcept {
+    if (is_refill || pending_pool_controllers_ == 0) {
+        return;
+    }
+
+    if (--pending_pool_controllers_ == 0) {
+        ControllerPoolFilled();
+    }
+}
+
+void WebViewPreLaunchControllerWin::ControllerPoolFilled() noexcept {
+    if (!options_.warm_up.before_ready) {
+        // Release the semaphore to indicate that the WebView and its pool are ready
+        telemetry_.ready = telemetry_.DurationSinceLaunch();
+        WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kReady, telemetry_.ready);
+        semaphore_.release();
+    }
+    StartWarmUp();
+}
+
+void WebViewPreLaunchControllerWin::ClearControllerPool() noexcept {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    for (auto& [profile_name, controllers] : controller_pool_) {
+        for (auto& controller : controllers) {
+            controller->Close();
+        }
+    }
+    controller_pool_.clear();
+}
+
+bool WebViewPreLaunchControllerWin::PostTask(std::function<void()> task) {
+    if (launch_thread_id_ == 0) {
+        return false;
+    }
+
+    auto wrapped_task = std::make_unique<std::function<void()>>([this, task = std::move(task)]() {
+        try {
+            task();
+        }
+        catch(...) {
+            auto ce = std::current_exception();
+            HandleException(ce, telemetry_, "Unknown exception occurred in a posted task");
+        }
+    });
+    if (!PostThreadMessage(launch_thread_id_, kRunTaskMessage, 0, reinterpret_cast<LPARAM>(wrapped_task.get()))) {
+        return false;
+    }
+    wrapped_task.release();
+    return true;
+}
+
+void WebViewPreLaunchControllerWin::PostDelayedTask(std::chrono::milliseconds delay, std::function<void()> task) {
+    // A thread timer, so the WM_TIMER arrives with a null HWND and is picked up by the message loop.
+    UINT_PTR timer_id = SetTimer(nullptr, 0, static_cast<UINT>(delay.count()), nullptr);
+    THROW_LAST_ERROR_IF(timer_id == 0);
+    delayed_tasks_[timer_id] = std::move(task);
+}
+
+void WebViewPreLaunchControllerWin::RunDelayedTask(UINT_PTR timer_id) noexcept {
+    KillTimer(nullptr, timer_id);
+
+    auto delayed_task = delayed_tasks_.find(timer_id);
+    if (delayed_task == delayed_tasks_.end()) {
+        return;
+    }
+    auto task = std::move(delayed_task->second);
+    delayed_tasks_.erase(delayed_task);
+    task();
+}
+
+void WebViewPreLaunchControllerWin::StartWarmUp() noexcept {
+    try {
+        warm_up_urls_ = options_.warm_up.urls;
+        if (!options_.warm_up.urls_file.empty()) {
+            std::ifstream urls_file(options_.warm_up.urls_file);
+            if (!urls_file.is_open()) {
+                throw std::runtime_error("Failed to open warm-up URLs file " + options_.warm_up.urls_file.string());
+            }
+
+            std::string url;
+            while (std::getline(urls_file, url)) {
+                if (!url.empty() && url.back() == '\r') {
+                    url.pop_back();
+                }
+                if (!url.empty()) {
+                    warm_up_urls_.push_back(url);
+                }
+            }
+        }
+    }
+    catch(...) {
+        auto ce = std::current_exception();
+        HandleException(ce, telemetry_, "Unknown exception occurred in StartWarmUp");
+    }
+
+    warm_up_index_ = 0;
+    WarmUpNextUrl();
+}
+
+void WebViewPreLaunchControllerWin::WarmUpNextUrl() noexcept {
+    if (warm_up_index_ >= warm_up_urls_.size()) {
+        if (!warm_up_urls_.empty()) {
+            telemetry_.warm_up_completed = telemetry_.DurationSinceLaunch();
+            WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kWarmUpCompleted, telemetry_.warm_up_completed);
+        }
+        if (options_.warm_up.before_ready) {
+            // Release the semaphore to indicate that the WebView is ready and warmed up
+            telemetry_.ready = telemetry_.DurationSinceLaunch();
+            WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kReady, telemetry_.ready);
+            semaphore_.release();
+        }
+        warm_up_urls_.clear();
+        return;
+    }
+
+    WebViewWarmUpTiming timing;
+    timing.url = warm_up_urls_[warm_up_index_];
+    timing.started = telemetry_.DurationSinceLaunch();
+    telemetry_.warm_up.push_back(timing);
+    warm_up_url_started_ = std::chrono::high_resolution_clock::now();
+
+    size_t warm_up_index = warm_up_index_;
+    try {
+        PostDelayedTask(options_.warm_up.per_url_budget, [this, warm_up_index]() {
+            WarmUpUrlTimedOut(warm_up_index);
+        });
+        webviewController_->Navigate(timing.url, [this, warm_up_index](bool is_success) {
+            WarmUpUrlCompleted(warm_up_index, is_success);
+        });
+    }
+    catch(...) {
+        auto ce = std::current_exception();
+        HandleException(ce, telemetry_, "Unknown exception occurred in WarmUpNextUrl");
+        WarmUpUrlCompleted(warm_up_index, /*is_success*/false);
+    }
+}
+
+void WebViewPreLaunchControllerWin::WarmUpUrlTimedOut(size_t warm_up_index) noexcept try {
+    if (warm_up_index != warm_up_index_ || warm_up_index_ >= warm_up_urls_.size()) {
+        return;
+    }
+
+    // Stopping completes the navigation, which moves on to the next URL.  Waiting for that rather
+    // than navigating right away keeps the late completion from being taken for the next URL's.
+    telemetry_.warm_up.back().timed_out = true;
+    WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kWarmUpTimeouts);
+    webviewController_->StopNavigation();
+}
+catch(...) {
+    auto ce = std::current_exception();
+    HandleException(ce, telemetry_, "Unknown exception occurred in WarmUpUrlTimedOut");
+    WarmUpUrlCompleted(warm_up_index, /*is_success*/false);
+}
+
+void WebViewPreLaunchControllerWin::WarmUpUrlCompleted(size_t warm_up_index, bool is_success) noexcept {
+    if (warm_up_index != warm_up_index_ || warm_up_index_ >= warm_up_urls_.size()) {
+        return;
+    }
+
+    auto& timing = telemetry_.warm_up.back();
+    timing.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - warm_up_url_started_);
+    timing.succeeded = is_success;
+
+    ++warm_up_index_;
+    WarmUpNextUrl();
+}
+
+void WebViewPreLaunchControllerWin::StopWarmUp() noexcept try {
+    if (warm_up_index_ >= warm_up_urls_.size()) {
+        return;
+    }
+
+    // Jumping past the end makes the pending completion and timeout no-ops.
+    warm_up_index_ = warm_up_urls_.size();
+    webviewController_->StopNavigation();
+}
+catch(...) {
+    auto ce = std::current_exception();
+    HandleException(ce, telemetry_, "Unknown exception occurred in StopWarmUp");
+}
+
+bool WebViewPreLaunchControllerWin::AcquirePooledController(
+    const std::string& profile_name,
+    HWND parent,
+    std::function<void(std::shared_ptr<WebViewBackendController>)> on_acquired) {
+    auto count_miss = [this]() {
+        ++telemetry_.controller_pool_misses;
+        WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kControllerPoolMisses);
+    };
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        auto pool = controller_pool_.find(profile_name);
+        if (pool == controller_pool_.end() || pool->second.empty()) {
+            count_miss();
+            return false;
+        }
+    }
+
+    // The controller is only taken out of the pool on the pre-launch thread, so one that can't be
+    // handed over stays there to be closed on its own thread.
+    bool posted = PostTask([this, profile_name, parent, count_miss, on_acquired = std::move(on_acquired)]() {
+        std::shared_ptr<WebViewBackendController> controller;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            auto pool = controller_pool_.find(profile_name);
+            if (pool == controller_pool_.end() || pool->second.empty()) {
+                // Another acquire took the last one in the meantime.
+                count_miss();
+            } else {
+                controller = std::move(pool->second.front());
+                pool->second.pop_front();
+                ++telemetry_.controller_pool_hits;
+                WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter::kControllerPoolHits);
+            }
+        }
+
+        if (controller != nullptr) {
+            try {
+                CreatePooledController(profile_name, /*is_refill*/true);
+            }
+            catch(...) {
+                auto ce = std::current_exception();
+                HandleException(ce, telemetry_, "Unknown exception occurred refilling the controller pool");
+            }
+
+            try {
+                if (parent != nullptr) {
+                    controller->SetParentWindow(parent);
+                }
+            }
+            catch(...) {
+                auto ce = std::current_exception();
+                HandleException(ce, telemetry_, "Unknown exception occurred reparenting a pooled controller");
+                controller->Close();
+                controller.reset();
+            }
+        }
+        // Always called, so a host waiting on it never hangs.
+        on_acquired(std::move(controller));
+    });
+    if (!posted) {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        count_miss();
+    }
+    return posted;
+}
+
+bool WebViewPreLaunchControllerWin::Adopt(
+    HWND parent,
+    std::function<void(std::shared_ptr<WebViewBackendEnvironment>, std::shared_ptr<WebViewBackendController>)> on_adopted) {
+    if (!controller_created_ || adopt_requested_.exchange(true)) {
+        return false;
+    }
+
+    bool posted = PostTask([this, parent, on_adopted = std::move(on_adopted)]() {
+        std::shared_ptr<WebViewBackendEnvironment> environment;
+        std::shared_ptr<WebViewBackendController> controller;
+        try {
+            if (webviewController_ != nullptr) {
+                // The host navigates the webview from here on.
+                StopWarmUp();
+                if (parent != nullptr) {
+                    webviewController_->SetParentWindow(parent);
+                }
+                environment = environment_;
+                controller = webviewController_;
+                adopted_ = true;
+            }
+        }
+        catch(...) {
+            auto ce = std::current_exception();
+            HandleException(ce, telemetry_, "Unknown exception occurred in Adopt");
+        }
+        // Always called, so a host waiting on it never hangs.  The tree is only handed out, and
+        // its browser process left running at close, when both are set.
+        on_adopted(std::move(environment), std::move(controller));
+        if (adopted_) {
+            telemetry_.adopt_completed = telemetry_.DurationSinceLaunch();
+            WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kAdopted, telemetry_.adopt_completed);
+        }
+    });
+    if (!posted) {
+        adopt_requested_ = false;
+    }
+    return posted;
+}
+
 void WebViewPreLaunchControllerWin::Close(bool wait_for_browser_process_exit) {
+    // The launch thread reads what the first call set, and a detached teardown may already have
+    // settled the telemetry.
+    if (close_requested_.exchange(true)) {
+        return;
+    }
     telemetry_.close_started = telemetry_.DurationSinceLaunch();
 
     wait_for_browser_process_exit_ = wait_for_browser_process_exit;
     background_thread_should_exit_ = true;
+    runtime_tasks_stopped_ = true;
+    // Abandons a launch that is still deferred.
+    launch_trigger_->Fire("closed");
+
+    if (backgroundHwnd_ != nullptr) {
+        PostMessage(backgroundHwnd_, WM_CLOSE, 0, 0);
+    }
+
+    if (options_.close_mode == WebViewCloseMode::kDetach) {
+        DetachTeardown();
+    }
+}
 
-    if (backgroundHwnd_ == nullptr) {
+void WebViewPreLaunchControllerWin::DetachTeardown() {
+    // The reaper holds a reference, so the controller outlives the launch thread however long the
+    // teardown takes.  Without an owning shared_ptr there is nothing to hold, and WaitForClose
+    // joins as in kJoin mode.
+    auto self = weak_from_this().lock();
+    if (self == nullptr || teardown_detached_ || !launch_thread_.joinable()) {
         return;
     }
 
-    PostMessage(backgroundHwnd_, WM_CLOSE, 0, 0);
+    try {
+        std::thread([self]() {
+            self->launch_thread_.join();
+        }).detach();
+        teardown_detached_ = true;
+    }
+    catch (const std::system_error&) {
+        // Without a reaper, WaitForClose joins instead.
+    }
 }
 
 void WebViewPreLaunchControllerWin::WaitForClose() {
-    if (launch_thread_.joinable()) {
+    if (!teardown_detached_ && launch_thread_.joinable()) {
         launch_thread_.join();
+    } else if (teardown_detached_) {
+        // The reaper waits for the browser process, but everything the teardown reports is in the
+        // telemetry by now.
+        telemetry_settled_.wait(false);
     }
     telemetry_.waitforclose_completed = telemetry_.DurationSinceLaunch();
 }
@@ -253,6 +930,21 @@ void WebViewPreLaunchControllerWin::WaitForLaunch() {
     telemetry_.waitforlaunch_completed = telemetry_.DurationSinceLaunch();
 }
 
+void WebViewPreLaunchControllerWin::WaitForLaunchSettled() {
+    semaphore_.acquire();
+    semaphore_.release();
+}
+
+bool WebViewPreLaunchControllerWin::MatchesPreLaunchArgs(const WebViewCreationArguments& args) {
+    // The options are only set once the pre-launch read its args.
+    bool matches = environment_options_ != nullptr && environment_options_->GetArgs() == args;
+    if (telemetry_.args_match.empty()) {
+        telemetry_.args_match = matches ? "hit" : "miss";
+        WebViewPreLaunchMetrics::IncrementCounter(matches ? WebViewPreLaunchCounter::kArgsHits : WebViewPreLaunchCounter::kArgsMisses);
+    }
+    return matches;
+}
+
 void WebViewPreLaunchControllerWin::CacheWebViewCreationArguments(const std::filesystem::path& cache_args_path, const WebViewCreationArguments& args) noexcept try {
     std::ofstream cache_file(cache_args_path);
     cache_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
@@ -299,6 +991,10 @@ WebViewCreationArguments WebViewPreLaunchControllerWin::ReadCachedWebViewCreatio
     return j.get<WebViewCreationArguments>();
 }
 
+std::shared_ptr<const WebViewEnvironmentOptions> WebViewPreLaunchControllerWin::GetEnvironmentOptions() const {
+    return environment_options_;
+}
+
 uint32_t WebViewPreLaunchControllerWin::GetBrowserProcessId() const {
     return browser_process_id_;
 }
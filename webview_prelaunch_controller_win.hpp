@@ -1,56 +1,178 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
 #include <semaphore>
 #include <string>
 #include <thread>
+#include <vector>
 
-#include <WebView2.h>
-#include <WebView2EnvironmentOptions.h>
-#include <wil/com.h>
+#include <atomic>
 #include <windows.h>
-#include <wrl.h>
-#include <wrl/event.h>
 
+#include "webview_backend_webview2_win.hpp"
+#include "webview_args_source.hpp"
+#include "webview_backend_win.hpp"
 #include "webview_creation_arguments.hpp"
 #include "webview_prelaunch_controller.hpp"
+#include "webview_runtime_identity.hpp"
 
-class WebViewPreLaunchControllerWin : public  WebViewPreLaunchController {
+class WebViewLaunchTrigger;
+
+class WebViewPreLaunchControllerWin : public  WebViewPreLaunchController,
+                                      public std::enable_shared_from_this<WebViewPreLaunchControllerWin> {
 private:
-    wil::com_ptr<ICoreWebView2> webview_;
-    wil::com_ptr<ICoreWebView2Controller> webviewController_;
+    std::shared_ptr<WebViewBackend> backend_;
+    std::shared_ptr<const WebViewEnvironmentOptions> environment_options_;
+    std::shared_ptr<WebViewBackendEnvironment> environment_;
+    std::shared_ptr<WebViewBackendController> webviewController_;
     std::binary_semaphore semaphore_;
     std::thread launch_thread_;
     bool background_thread_should_exit_ = false;
     bool wait_for_browser_process_exit_ = false;
+    // Set on the pre-launch thread once the controller was created, for Adopt to check from the
+    // host's thread without touching webviewController_.
+    std::atomic<bool> controller_created_ = false;
+    std::atomic<bool> adopt_requested_ = false;
+    std::atomic<bool> adopted_ = false;
+    std::atomic<bool> close_requested_ = false;
+    // Set once Close handed the launch thread to a detached reaper, after which only the reaper
+    // touches launch_thread_.
+    std::atomic<bool> teardown_detached_ = false;
+    // Set by the pre-launch thread once it stopped writing telemetry_, before it waits for the
+    // browser process to exit.  Errors after that only reach the metrics.
+    std::atomic<bool> telemetry_settled_ = false;
     HWND backgroundHwnd_ = nullptr;
+    DWORD launch_thread_id_ = 0;
     uint32_t browser_process_id_ = 0;
+    // When the environment was requested, from which its creation time is measured.
+    std::chrono::milliseconds environment_requested_ = std::chrono::milliseconds::zero();
+    WebViewPreLaunchOptions options_;
+    WebViewLaunchStrategyOptions launch_strategy_;
+    std::shared_ptr<WebViewLaunchTrigger> launch_trigger_;
+    // Guards controller_pool_ and the pool telemetry, which hosts touch from their own thread.
+    std::mutex pool_mutex_;
+    std::map<std::string, std::deque<std::shared_ptr<WebViewBackendController>>> controller_pool_;
+    size_t pending_pool_controllers_ = 0;
+    std::map<UINT_PTR, std::function<void()>> delayed_tasks_;
+    std::vector<std::string> warm_up_urls_;
+    size_t warm_up_index_ = 0;
+    std::chrono::time_point<std::chrono::high_resolution_clock> warm_up_url_started_;
+    // Where the runtime identity is kept; empty for args sources without a cache file.
+    std::filesystem::path cache_args_path_;
+    // The runtime the last launch from cache_args_path_ ran against.
+    std::optional<WebViewRuntimeIdentity> stored_runtime_identity_;
+    // Resolves the runtime, prefetches an update and records the runtime's identity next to the
+    // launch, off its critical path.  Joined at teardown.
+    std::thread runtime_thread_;
+    // The browser process the runtime's identity is read from, once the controller was created, or
+    // 0 when teardown came first.  Set on the pre-launch thread only.
+    std::promise<uint32_t> runtime_browser_process_;
+    bool runtime_browser_process_set_ = false;
+    // Thrown on runtime_thread_ and reported once it was joined.
+    std::exception_ptr runtime_exception_;
+    // Set by Close and at teardown to cut a prefetch short.
+    std::atomic<bool> runtime_tasks_stopped_ = false;
     std::optional<WebViewCreationArguments> cached_args_;
     WebViewPreLaunchTelemetry telemetry_;
 
-    void LaunchBackground(const std::filesystem::path& cache_args_path) noexcept;
+    void LaunchBackground(std::shared_ptr<WebViewArgsSource> args_source) noexcept;
+    void ArmLaunchTrigger();
+    void DetachTeardown();
+    void SettleTelemetry() noexcept;
+    bool WaitForLaunchTrigger();
+    void RunRuntimeTasks(std::future<uint32_t> browser_process) noexcept;
+    void SetRuntimeBrowserProcess(uint32_t browser_process_id) noexcept;
+    void JoinRuntimeThread() noexcept;
+    std::filesystem::path ResolveRuntime() noexcept;
+    void RecordRuntimeIdentity(uint32_t browser_process_id);
     HWND CreateMessageWindow();
-    HRESULT EnvironmentCreatedCallback( HRESULT result, ICoreWebView2Environment* env) noexcept;
-    HRESULT ControllerCreatedCallback(HRESULT result, ICoreWebView2Controller* controller) noexcept;
+    HRESULT EnvironmentCreatedCallback(HRESULT result, std::shared_ptr<WebViewBackendEnvironment> env) noexcept;
+    HRESULT ControllerCreatedCallback(HRESULT result, std::shared_ptr<WebViewBackendController> controller) noexcept;
+    void FillControllerPool() noexcept;
+    void CreatePooledController(const std::string& profile_name, bool is_refill);
+    HRESULT PooledControllerCreatedCallback(
+        HRESULT result,
+        std::shared_ptr<WebViewBackendController> controller,
+        const std::string& profile_name,
+        std::chrono::time_point<std::chrono::high_resolution_clock> requested,
+        bool is_refill) noexcept;
+    void PooledControllerSettled(bool is_refill) noexcept;
+    void ClearControllerPool() noexcept;
+    void ControllerPoolFilled() noexcept;
+    void PostDelayedTask(std::chrono::milliseconds delay, std::function<void()> task);
+    void RunDelayedTask(UINT_PTR timer_id) noexcept;
+    void StartWarmUp() noexcept;
+    void WarmUpNextUrl() noexcept;
+    void WarmUpUrlTimedOut(size_t warm_up_index) noexcept;
+    void WarmUpUrlCompleted(size_t warm_up_index, bool is_success) noexcept;
+    void StopWarmUp() noexcept;
 
 public:
-    WebViewPreLaunchControllerWin();
+    explicit WebViewPreLaunchControllerWin(
+        std::shared_ptr<WebViewBackend> backend = std::make_shared<WebViewBackendWebView2>());
     ~WebViewPreLaunchControllerWin() override;
 
-    void Launch(const std::filesystem::path& cache_args_path);
+    // Reads the args from the JSON file at |cache_args_path|.
+    void Launch(const std::filesystem::path& cache_args_path,
+                const WebViewPreLaunchOptions& options = {});
+    // Launches with args the host already has, without reading any file for them.
+    void Launch(const WebViewCreationArguments& args,
+                const WebViewPreLaunchOptions& options = {});
+    void Launch(std::shared_ptr<WebViewArgsSource> args_source,
+                const WebViewPreLaunchOptions& options = {});
     void WaitForLaunch() override;
+    // Blocks like WaitForLaunch without recording the wait as the foreground's, for callers waiting
+    // on the host's behalf.
+    void WaitForLaunchSettled();
+    bool MatchesPreLaunchArgs(const WebViewCreationArguments& args) override;
     void Close(bool wait_for_browser_process_exit) override;
     void WaitForClose() override;
+    void SignalMilestone(const std::string& milestone) override;
 
     const std::optional<WebViewCreationArguments>& ReadCachedWebViewCreationArguments(const std::filesystem::path& cache_args_path) noexcept override;
     void CacheWebViewCreationArguments(const std::filesystem::path& cache_args_path, const WebViewCreationArguments& args) noexcept override;
 
     const WebViewPreLaunchTelemetry& GetTelemetry() const override;
 
+    // Runs |task| on the pre-launch thread.  WebView2 objects are bound to the thread that created
+    // them, so controllers handed out by this class must only be used from tasks posted here.
+    bool PostTask(std::function<void()> task);
+
+    // Takes a pre-created controller for |profile_name| out of the pool, reparents it into |parent|
+    // (unless null) and passes it to |on_acquired| on the pre-launch thread.  A replacement is
+    // created in the background.  Returns false on a pool miss, in which case the host should
+    // create its own controller.  Once this returned true, |on_acquired| is always called, with
+    // null if another acquire emptied the pool first or the controller couldn't be reparented.
+    bool AcquirePooledController(
+        const std::string& profile_name,
+        HWND parent,
+        std::function<void(std::shared_ptr<WebViewBackendController>)> on_acquired);
+
+    // The options the pre-launched environment was created with.  Available after WaitForLaunch
+    // unless the cached args couldn't be read.
+    std::shared_ptr<const WebViewEnvironmentOptions> GetEnvironmentOptions() const;
+
+    // Hands the pre-launched environment and controller to the host, reparented into |parent|
+    // (unless null), so the host doesn't create a second environment and controller to attach to
+    // the tree.  Call after WaitForLaunch.  |on_adopted| runs on the pre-launch thread, which keeps
+    // pumping messages for the adopted objects until Close; they must only be used from tasks
+    // queued with PostTask.  Returns false if the launch failed or the tree was already adopted.
+    // Once this returned true, |on_adopted| is always called, with nulls if the tree couldn't be
+    // handed over, e.g. because reparenting failed.
+    bool Adopt(HWND parent,
+               std::function<void(std::shared_ptr<WebViewBackendEnvironment>, std::shared_ptr<WebViewBackendController>)> on_adopted);
+
     // public for testing purposes
     static WebViewCreationArguments ReadCachedWebViewCreationArguments(std::istream& stream);
     static void CacheWebViewCreationArguments(std::ostream& stream, const WebViewCreationArguments& args);
@@ -1,19 +1,23 @@
-#include <boost/nowide/convert.hpp>
 #include <chrono>
 #include <fstream>
 #include <iostream>
 #include <shellscalingapi.h>
 #include <thread>
 #include <WebView2.h>
-#include <WebView2EnvironmentOptions.h>
 #include <wil/com.h>
 #include <windows.h>
 #include <wrl.h>
 #include <wrl/event.h>
+#include "webview_environment_options_win.hpp"
 #include "webview_prelaunch_controller.hpp"
+#include "webview_prelaunch_controller_win.hpp"
 
 using namespace Microsoft::WRL;
 
+// Posted to the demo window when adopting the pre-launched WebView2 failed after Adopt accepted the
+// request, so the message loop falls back to creating the demo's own.
+constexpr UINT kAdoptFailedMessage = WM_APP + 1;
+
 // Minimal Window Procedure function to facilitate WebView2 creation
 LRESULT CALLBACK DemoWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
     switch (uMsg) {
@@ -26,6 +30,70 @@ LRESULT CALLBACK DemoWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lPar
     }
 }
 
+// Navigates the webview and sizes it to the demo window.  Runs on whichever thread created it.
+void ShowWebView(HWND hwnd, ICoreWebView2Controller* webviewController) {
+    wil::com_ptr<ICoreWebView2> webview;
+    webviewController->get_CoreWebView2(&webview);
+
+    webview->add_NavigationStarting(
+        Callback<ICoreWebView2NavigationStartingEventHandler>(
+            [hwnd](ICoreWebView2* sender, ICoreWebView2NavigationStartingEventArgs* args) -> HRESULT {
+                LPWSTR uri;
+                args->get_Uri(&uri);
+                std::wcout << L"Navigation starting: " << uri << std::endl;
+                CoTaskMemFree(uri);
+
+                return S_OK;
+            }).Get(), nullptr);
+
+    webview->Navigate(L"https://www.bing.com");
+    webview->add_NavigationCompleted(
+        Callback<ICoreWebView2NavigationCompletedEventHandler>(
+            [hwnd](ICoreWebView2* sender, ICoreWebView2NavigationCompletedEventArgs* args) -> HRESULT {
+                BOOL isSuccess;
+                args->get_IsSuccess(&isSuccess);
+                std::cout << "Navigation completed: " << (isSuccess ? "Success" : "Failed") << std::endl;
+                return S_OK;
+            }).Get(), nullptr);
+
+    RECT bounds;
+    GetClientRect(hwnd, &bounds);
+    std::cout << "Window bounds: " << bounds.left << ", " << bounds.top << ", " << bounds.right << ", " << bounds.bottom << std::endl;
+    webviewController->put_Bounds(bounds);
+
+    BOOL visibility = FALSE;
+    webviewController->get_IsVisible(&visibility);
+    std::cout << "WV2 visibility: " << visibility << std::endl;
+}
+
+// Creates the demo's own WebView2 when the pre-launched one can't be adopted.
+HRESULT CreateDemoWebView(HWND hwnd, const WebViewCreationArguments& args, wil::com_ptr<ICoreWebView2Controller>& webviewController) {
+    // Initialize WebView2 from the same options snapshot the pre-launch uses
+    return WebViewEnvironmentOptions::Get(args)->CreateCoreWebView2Environment(
+        Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
+            [hwnd, &webviewController](HRESULT result, ICoreWebView2Environment* env) -> HRESULT {
+                if (FAILED(result)) {
+                    std::cerr << "Failed to create WebView2 environment: " << std::hex << result << std::endl;
+                    return result;
+                }
+
+                env->CreateCoreWebView2Controller(hwnd, Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
+                    [hwnd, &webviewController](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT {
+                        if (FAILED(result)) {
+                            std::cerr << "Failed to create WebView2 controller: " << std::hex << result << std::endl;
+                            return result;
+                        }
+
+                        if (controller != nullptr) {
+                            webviewController = controller;
+                            ShowWebView(hwnd, webviewController.get());
+                        }
+                        return S_OK;
+                    }).Get());
+                return S_OK;
+            }).Get());
+}
+
 int main() {
     // Set the process DPI awareness
     SetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE);
@@ -52,8 +120,9 @@ int main() {
     controller->WaitForLaunch();
     std::cout << "Done waiting for WebView prelaunch." << std::endl;
 
-    auto cached_args = controller->ReadCachedWebViewCreationArguments(cache_file_path);
-    if (!cached_args.has_value() || cached_args.value() != args) {
+    // Compares with the args the pre-launch ran with and counts the hit or miss.
+    bool prelaunch_hit = controller->MatchesPreLaunchArgs(args);
+    if (!prelaunch_hit) {
         std::cout << "Cached WebView creation arguments didn't match." << std::endl;
         
         controller->CacheWebViewCreationArguments(cache_file_path, args);
@@ -98,97 +167,41 @@ int main() {
     ShowWindow(hwnd, SW_SHOW);
 
     ////////////////////////////////////
-    // Initialize WebView2
-    auto options = Microsoft::WRL::Make<CoreWebView2EnvironmentOptions>();
-    options->put_AllowSingleSignOnUsingOSPrimaryAccount(true);
-
-    Microsoft::WRL::ComPtr<ICoreWebView2EnvironmentOptions7> options7;
-    options.As(&options7);
-    if (options7) {
-        options7->put_ChannelSearchKind(static_cast<COREWEBVIEW2_CHANNEL_SEARCH_KIND>(args.channel_search_kind));
-        options7->put_ReleaseChannels(static_cast<COREWEBVIEW2_RELEASE_CHANNELS>(args.release_channels_mask));
-    }
-    
-    std::wstring browser_exe_path = boost::nowide::widen(args.browser_exe_path);
-    std::wstring user_data_dir = boost::nowide::widen(args.user_data_dir);
-    std::wstring additional_browser_arguments = boost::nowide::widen(args.additional_browser_arguments);
-    std::wstring language = boost::nowide::widen(args.language);
+    // Adopt the pre-launched WebView2 when the args matched rather than creating a second
+    // environment and controller to attach to the tree.  It lives on the pre-launch thread, which
+    // keeps running until we close the pre-launch controller below.
+    auto prelaunch_controller_win = static_cast<WebViewPreLaunchControllerWin*>(controller.get());
+    bool adopted = prelaunch_hit && prelaunch_controller_win->Adopt(hwnd,
+        [hwnd](std::shared_ptr<WebViewBackendEnvironment> env, std::shared_ptr<WebViewBackendController> adopted_controller) {
+            if (adopted_controller == nullptr) {
+                // Called on the pre-launch thread, while the demo's WebView2 belongs on the UI thread.
+                std::cerr << "Failed to adopt pre-launched WebView2." << std::endl;
+                PostMessage(hwnd, kAdoptFailedMessage, 0, 0);
+                return;
+            }
+            std::cout << "Adopted pre-launched WebView2." << std::endl;
+            adopted_controller->GetCoreWebView2Controller()->put_IsVisible(TRUE);
+            ShowWebView(hwnd, adopted_controller->GetCoreWebView2Controller());
+        });
 
-    options->put_AdditionalBrowserArguments(additional_browser_arguments.c_str());
-    options->put_EnableTrackingPrevention(args.enable_tracking_prevention);
-    options->put_Language(language.c_str());
-
-    wil::com_ptr<ICoreWebView2Environment> webviewEnvironment;
     wil::com_ptr<ICoreWebView2Controller> webviewController;
-    wil::com_ptr<ICoreWebView2> webview;
-    hr = CreateCoreWebView2EnvironmentWithOptions(
-        browser_exe_path.c_str(),
-        user_data_dir.c_str(),
-        options.Get(),
-        Callback<ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler>(
-            [hwnd, &webviewEnvironment, &webviewController, &webview, &prelaunchController = controller](HRESULT result, ICoreWebView2Environment* env) -> HRESULT {
-                if (FAILED(result)) {
-                    std::cerr << "Failed to create WebView2 environment: " << std::hex << result << std::endl;
-                    return result;
-                }
-                webviewEnvironment = env;
-
-                env->CreateCoreWebView2Controller(hwnd, Callback<ICoreWebView2CreateCoreWebView2ControllerCompletedHandler>(
-                    [hwnd, &webviewController, &webview, &prelaunchController](HRESULT result, ICoreWebView2Controller* controller) -> HRESULT {
-                        // Close our background HWND (but don't wait on it)
-                        // prelaunchController->Close();
-
-                        if (FAILED(result)) {
-                            std::cerr << "Failed to create WebView2 controller: " << std::hex << result << std::endl;
-                            return result;
-                        }
-
-                        if (controller != nullptr) {
-                            webviewController = controller;
-                            webviewController->get_CoreWebView2(&webview);
-
-                            webview->add_NavigationStarting(
-                                Callback<ICoreWebView2NavigationStartingEventHandler>(
-                                    [hwnd](ICoreWebView2* sender, ICoreWebView2NavigationStartingEventArgs* args) -> HRESULT {
-                                        LPWSTR uri;
-                                        args->get_Uri(&uri);
-                                        std::wcout << L"Navigation starting: " << uri << std::endl;
-                                        CoTaskMemFree(uri);
-
-                                        return S_OK;
-                                    }).Get(), nullptr);
-
-                            webview->Navigate(L"https://www.bing.com");
-                            webview->add_NavigationCompleted(
-                                Callback<ICoreWebView2NavigationCompletedEventHandler>(
-                                    [hwnd](ICoreWebView2* sender, ICoreWebView2NavigationCompletedEventArgs* args) -> HRESULT {
-                                        BOOL isSuccess;
-                                        args->get_IsSuccess(&isSuccess);
-                                        std::cout << "Navigation completed: " << (isSuccess ? "Success" : "Failed") << std::endl;
-                                        return S_OK;
-                                    }).Get(), nullptr);
-
-                            RECT bounds;
-                            GetClientRect(hwnd, &bounds);
-                            std::cout << "Window bounds: " << bounds.left << ", " << bounds.top << ", " << bounds.right << ", " << bounds.bottom << std::endl;
-                            webviewController->put_Bounds(bounds);
-
-                            BOOL visibility = FALSE;
-                            webviewController->get_IsVisible(&visibility);
-                            std::cout << "WV2 visibility: " << visibility << std::endl;
-                        }
-                        return S_OK;
-                    }).Get());
-                return S_OK;
-            }).Get());
-
-    if (FAILED(hr)) {
-        std::cerr << "Failed to create WebView2 environment: " << std::hex << hr << std::endl;
+    if (!adopted) {
+        hr = CreateDemoWebView(hwnd, args, webviewController);
+        if (FAILED(hr)) {
+            std::cerr << "Failed to create WebView2 environment: " << std::hex << hr << std::endl;
+        }
     }
     
     // Run the message loop
     MSG msg = {};
     while (GetMessage(&msg, NULL, 0, 0)) {
+        if (msg.hwnd == hwnd && msg.message == kAdoptFailedMessage) {
+            hr = CreateDemoWebView(hwnd, args, webviewController);
+            if (FAILED(hr)) {
+                std::cerr << "Failed to create WebView2 environment: " << std::hex << hr << std::endl;
+            }
+            continue;
+        }
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
@@ -0,0 +1,284 @@
+#include "webview_prelaunch_metrics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <map>
+#include <string>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace {
+// Bucket i counts latencies under 2^i ms, from the previous bucket's bound up.  2^15 ms is about
+// half a minute, so the unbounded last bucket only catches hung launches.
+constexpr size_t kHistogramBuckets = 17;
+
+struct AtomicHistogram {
+    std::array<std::atomic<uint64_t>, kHistogramBuckets> buckets = {};
+    std::atomic<int64_t> sum = 0;
+};
+
+constexpr size_t kMilestones = static_cast<size_t>(WebViewPreLaunchMilestone::kCount);
+constexpr size_t kPhases = static_cast<size_t>(WebViewLaunchPhase::kCount);
+constexpr size_t kCounters = static_cast<size_t>(WebViewPreLaunchCounter::kCount);
+
+std::array<AtomicHistogram, kMilestones> milestone_latencies;
+std::array<AtomicHistogram, kPhases> phase_durations;
+std::array<std::atomic<uint64_t>, kCounters> counters = {};
+
+void AddToHistogram(AtomicHistogram& histogram, std::chrono::milliseconds value) {
+    auto latency = static_cast<uint64_t>(std::max<int64_t>(value.count(), 0));
+    auto bucket = std::min<size_t>(std::bit_width(latency), kHistogramBuckets - 1);
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    histogram.sum.fetch_add(value.count(), std::memory_order_relaxed);
+}
+
+WebViewPreLaunchHistogram SnapshotHistogram(const AtomicHistogram& histogram) {
+    WebViewPreLaunchHistogram snapshot_histogram;
+    for (size_t bucket = 0; bucket < kHistogramBuckets; ++bucket) {
+        WebViewPreLaunchHistogramBucket snapshot_bucket;
+        if (bucket + 1 < kHistogramBuckets) {
+            snapshot_bucket.upper_bound = std::chrono::milliseconds(int64_t{1} << bucket);
+        }
+        snapshot_bucket.count = histogram.buckets[bucket].load(std::memory_order_relaxed);
+        snapshot_histogram.buckets.push_back(snapshot_bucket);
+        snapshot_histogram.count += snapshot_bucket.count;
+    }
+    snapshot_histogram.sum = std::chrono::milliseconds(histogram.sum.load(std::memory_order_relaxed));
+    return snapshot_histogram;
+}
+
+// Checked before anything else so recording stays lock-free while no hook is registered.
+std::atomic<size_t> registered_hooks = 0;
+
+struct Hooks {
+    std::mutex mutex;
+    WebViewPreLaunchMetrics::HookId next_hook_id = 1;
+    std::map<WebViewPreLaunchMetrics::HookId, WebViewPreLaunchMilestoneHook> milestone_hooks;
+    std::map<WebViewPreLaunchMetrics::HookId, WebViewPreLaunchErrorHook> error_hooks;
+    // Calls in progress, by hook and calling thread, for RemoveHook to wait out.
+    std::vector<std::pair<WebViewPreLaunchMetrics::HookId, std::thread::id>> running;
+    std::condition_variable call_finished;
+};
+
+// Never destroyed, since a detached teardown can still be recording while the process exits.
+Hooks& GetHooks() {
+    static auto& hooks = *new Hooks();
+    return hooks;
+}
+
+// Calls every hook registered in |hooks|.  Hooks are called outside the lock so that they can
+// remove themselves, and each call is marked running so that RemoveHook can wait for it.
+template <class Hook, class... Args>
+void CallHooks(std::map<WebViewPreLaunchMetrics::HookId, Hook> Hooks::*hooks, const Args&... args) {
+    auto& state = GetHooks();
+    std::vector<WebViewPreLaunchMetrics::HookId> hook_ids;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (const auto& [hook_id, hook] : state.*hooks) {
+            hook_ids.push_back(hook_id);
+        }
+    }
+
+    auto this_thread = std::this_thread::get_id();
+    for (auto hook_id : hook_ids) {
+        {
+            Hook hook;
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                auto registered = (state.*hooks).find(hook_id);
+                if (registered == (state.*hooks).end()) {
+                    // Removed since the ids were collected.
+                    continue;
+                }
+                hook = registered->second;
+                state.running.emplace_back(hook_id, this_thread);
+            }
+            try {
+                hook(args...);
+            }
+            catch(...) {}
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.running.erase(std::find(state.running.begin(), state.running.end(), std::make_pair(hook_id, this_thread)));
+        }
+        state.call_finished.notify_all();
+    }
+}
+}  // namespace
+
+const char* GetMilestoneName(WebViewPreLaunchMilestone milestone) {
+    switch (milestone) {
+        case WebViewPreLaunchMilestone::kLaunchStarted: return "launch_started";
+        case WebViewPreLaunchMilestone::kLaunchTriggered: return "launch_triggered";
+        case WebViewPreLaunchMilestone::kCachedArgsRead: return "cached_args_read";
+        case WebViewPreLaunchMilestone::kWindowCreated: return "window_created";
+        case WebViewPreLaunchMilestone::kEnvironmentCreated: return "environment_created";
+        case WebViewPreLaunchMilestone::kControllerCreated: return "controller_created";
+        case WebViewPreLaunchMilestone::kReady: return "ready";
+        case WebViewPreLaunchMilestone::kWarmUpCompleted: return "warm_up_completed";
+        case WebViewPreLaunchMilestone::kAdopted: return "adopted";
+        case WebViewPreLaunchMilestone::kCount: break;
+    }
+    return "unknown";
+}
+
+const char* GetPhaseName(WebViewLaunchPhase phase) {
+    switch (phase) {
+        case WebViewLaunchPhase::kReadCachedArgs: return "read_cached_args";
+        case WebViewLaunchPhase::kBuildOptions: return "build_options";
+        case WebViewLaunchPhase::kInitApartment: return "init_apartment";
+        case WebViewLaunchPhase::kCreateWindow: return "create_window";
+        case WebViewLaunchPhase::kRequestEnvironment: return "request_environment";
+        case WebViewLaunchPhase::kCreateEnvironment: return "create_environment";
+        case WebViewLaunchPhase::kCreateController: return "create_controller";
+        case WebViewLaunchPhase::kCount: break;
+    }
+    return "unknown";
+}
+
+std::optional<WebViewLaunchPhase> FindPhase(const std::string& name) {
+    for (size_t phase = 0; phase < kPhases; ++phase) {
+        if (name == GetPhaseName(static_cast<WebViewLaunchPhase>(phase))) {
+            return static_cast<WebViewLaunchPhase>(phase);
+        }
+    }
+    return std::nullopt;
+}
+
+const char* GetCounterName(WebViewPreLaunchCounter counter) {
+    switch (counter) {
+        case WebViewPreLaunchCounter::kLaunches: return "launches";
+        case WebViewPreLaunchCounter::kArgsHits: return "args_hits";
+        case WebViewPreLaunchCounter::kArgsMisses: return "args_misses";
+        case WebViewPreLaunchCounter::kControllerPoolHits: return "controller_pool_hits";
+        case WebViewPreLaunchCounter::kControllerPoolMisses: return "controller_pool_misses";
+        case WebViewPreLaunchCounter::kWarmUpTimeouts: return "warm_up_timeouts";
+        case WebViewPreLaunchCounter::kLaunchDeferralTimeouts: return "launch_deferral_timeouts";
+        case WebViewPreLaunchCounter::kRuntimeChanges: return "runtime_changes";
+        case WebViewPreLaunchCounter::kErrors: return "errors";
+        case WebViewPreLaunchCounter::kCount: break;
+    }
+    return "unknown";
+}
+
+/* static */
+WebViewPreLaunchMetrics::HookId WebViewPreLaunchMetrics::AddMilestoneHook(WebViewPreLaunchMilestoneHook hook) {
+    auto& hooks = GetHooks();
+    std::lock_guard<std::mutex> lock(hooks.mutex);
+    auto hook_id = hooks.next_hook_id++;
+    hooks.milestone_hooks.emplace(hook_id, std::move(hook));
+    ++registered_hooks;
+    return hook_id;
+}
+
+/* static */
+WebViewPreLaunchMetrics::HookId WebViewPreLaunchMetrics::AddErrorHook(WebViewPreLaunchErrorHook hook) {
+    auto& hooks = GetHooks();
+    std::lock_guard<std::mutex> lock(hooks.mutex);
+    auto hook_id = hooks.next_hook_id++;
+    hooks.error_hooks.emplace(hook_id, std::move(hook));
+    ++registered_hooks;
+    return hook_id;
+}
+
+/* static */
+void WebViewPreLaunchMetrics::RemoveHook(HookId hook_id) {
+    auto& hooks = GetHooks();
+    std::unique_lock<std::mutex> lock(hooks.mutex);
+    if (hooks.milestone_hooks.erase(hook_id) + hooks.error_hooks.erase(hook_id) > 0) {
+        --registered_hooks;
+    }
+
+    // A hook removing itself is still running on this thread, and waiting for that would never end.
+    auto this_thread = std::this_thread::get_id();
+    hooks.call_finished.wait(lock, [&hooks, hook_id, this_thread]() {
+        return std::none_of(hooks.running.begin(), hooks.running.end(), [hook_id, this_thread](const auto& call) {
+            return call.first == hook_id && call.second != this_thread;
+        });
+    });
+}
+
+/* static */
+void WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone milestone, std::chrono::milliseconds since_launch) noexcept {
+    AddToHistogram(milestone_latencies[static_cast<size_t>(milestone)], since_launch);
+
+    if (registered_hooks.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    try {
+        CallHooks(&Hooks::milestone_hooks, milestone, since_launch);
+    }
+    catch(...) {}
+}
+
+/* static */
+void WebViewPreLaunchMetrics::RecordPhaseDuration(WebViewLaunchPhase phase, std::chrono::milliseconds duration) noexcept {
+    AddToHistogram(phase_durations[static_cast<size_t>(phase)], duration);
+}
+
+/* static */
+void WebViewPreLaunchMetrics::IncrementCounter(WebViewPreLaunchCounter counter) noexcept {
+    counters[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+}
+
+/* static */
+void WebViewPreLaunchMetrics::RecordError(const std::string& error) noexcept {
+    IncrementCounter(WebViewPreLaunchCounter::kErrors);
+
+    if (registered_hooks.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    try {
+        CallHooks(&Hooks::error_hooks, error);
+    }
+    catch(...) {}
+}
+
+/* static */
+WebViewPreLaunchMetricsSnapshot WebViewPreLaunchMetrics::Snapshot() {
+    WebViewPreLaunchMetricsSnapshot snapshot;
+    for (size_t counter = 0; counter < kCounters; ++counter) {
+        snapshot.counters[GetCounterName(static_cast<WebViewPreLaunchCounter>(counter))] =
+            counters[counter].load(std::memory_order_relaxed);
+    }
+
+    for (size_t milestone = 0; milestone < kMilestones; ++milestone) {
+        snapshot.milestone_latencies[GetMilestoneName(static_cast<WebViewPreLaunchMilestone>(milestone))] =
+            SnapshotHistogram(milestone_latencies[milestone]);
+    }
+
+    for (size_t phase = 0; phase < kPhases; ++phase) {
+        snapshot.phase_durations[GetPhaseName(static_cast<WebViewLaunchPhase>(phase))] =
+            SnapshotHistogram(phase_durations[phase]);
+    }
+    return snapshot;
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchHistogram& histogram) {
+    auto buckets = nlohmann::json::array();
+    for (const auto& bucket : histogram.buckets) {
+        buckets.push_back({
+            {"upper_bound", bucket.upper_bound.has_value() ? nlohmann::json(bucket.upper_bound->count()) : nlohmann::json()},
+            {"count", bucket.count}
+        });
+    }
+    j = nlohmann::json{
+        {"buckets", buckets},
+        {"count", histogram.count},
+        {"sum", histogram.sum.count()}
+    };
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchMetricsSnapshot& snapshot) {
+    j = nlohmann::json{
+        {"counters", snapshot.counters},
+        {"milestone_latencies", snapshot.milestone_latencies},
+        {"phase_durations", snapshot.phase_durations}
+    };
+}
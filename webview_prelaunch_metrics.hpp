@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+// Live metrics for the pre-launches in this process.  Unlike WebViewPreLaunchTelemetry, which is
+// read after the fact, hooks see events as they happen and the counters and histograms can be
+// scraped at any time.
+
+enum class WebViewPreLaunchMilestone {
+  kLaunchStarted,
+  kLaunchTriggered,
+  kCachedArgsRead,
+  kWindowCreated,
+  kEnvironmentCreated,
+  kControllerCreated,
+  // WaitForLaunch returns from here on.
+  kReady,
+  kWarmUpCompleted,
+  kAdopted,
+  kCount,
+};
+
+// The launch phases recorded in WebViewPreLaunchTelemetry::launch_phases, followed by the two
+// asynchronous WebView2 creations that complete after them.
+enum class WebViewLaunchPhase {
+  kReadCachedArgs,
+  kBuildOptions,
+  kInitApartment,
+  kCreateWindow,
+  kRequestEnvironment,
+  kCreateEnvironment,
+  kCreateController,
+  kCount,
+};
+
+enum class WebViewPreLaunchCounter {
+  kLaunches,
+  // Hosts finding their args equal to the ones the pre-launch ran with, so that they can use the
+  // pre-launched tree, or different, so that it was started for nothing.
+  kArgsHits,
+  kArgsMisses,
+  kControllerPoolHits,
+  kControllerPoolMisses,
+  // Warm-up navigations stopped for running over their budget.
+  kWarmUpTimeouts,
+  // Deferred launches started by max_deferral rather than their trigger.
+  kLaunchDeferralTimeouts,
+  // Launches finding the runtime updated since the last launch from the same cached args.
+  kRuntimeChanges,
+  kErrors,
+  kCount,
+};
+
+const char* GetMilestoneName(WebViewPreLaunchMilestone milestone);
+const char* GetPhaseName(WebViewLaunchPhase phase);
+// The phase named |name|, as in WebViewPreLaunchTelemetry::launch_phases, if there is one.
+std::optional<WebViewLaunchPhase> FindPhase(const std::string& name);
+const char* GetCounterName(WebViewPreLaunchCounter counter);
+
+struct WebViewPreLaunchHistogramBucket {
+  // Exclusive; the last bucket is unbounded.
+  std::optional<std::chrono::milliseconds> upper_bound;
+  uint64_t count = 0;
+};
+
+// Distribution of durations, e.g. of the time from Launch until a milestone.  Buckets double in
+// width.
+struct WebViewPreLaunchHistogram {
+  std::vector<WebViewPreLaunchHistogramBucket> buckets;
+  uint64_t count = 0;
+  std::chrono::milliseconds sum = std::chrono::milliseconds::zero();
+};
+
+struct WebViewPreLaunchMetricsSnapshot {
+  std::map<std::string, uint64_t> counters;
+  std::map<std::string, WebViewPreLaunchHistogram> milestone_latencies;
+  // How long each launch phase took, by GetPhaseName.
+  std::map<std::string, WebViewPreLaunchHistogram> phase_durations;
+};
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchHistogram& histogram);
+void to_json(nlohmann::json& j, const WebViewPreLaunchMetricsSnapshot& snapshot);
+
+using WebViewPreLaunchMilestoneHook =
+  std::function<void(WebViewPreLaunchMilestone milestone, std::chrono::milliseconds since_launch)>;
+using WebViewPreLaunchErrorHook = std::function<void(const std::string& error)>;
+
+class WebViewPreLaunchMetrics {
+public:
+  using HookId = uint64_t;
+
+  // Hooks run on the thread recording the event, usually the pre-launch thread, so they should
+  // hand the event off rather than block.  Exceptions they throw are dropped.
+  static HookId AddMilestoneHook(WebViewPreLaunchMilestoneHook hook);
+  static HookId AddErrorHook(WebViewPreLaunchErrorHook hook);
+  // Once this returns the hook is no longer called, and calls of it on other threads have
+  // returned, so what it captured can be destroyed.  It blocks for those calls, so don't remove a
+  // hook while holding a lock the hook takes.  A hook may remove itself.
+  static void RemoveHook(HookId hook_id);
+
+  // Recording only touches atomics, and takes a lock and copies the hooks only while some are
+  // registered.
+  static void RecordMilestone(WebViewPreLaunchMilestone milestone, std::chrono::milliseconds since_launch) noexcept;
+  static void RecordPhaseDuration(WebViewLaunchPhase phase, std::chrono::milliseconds duration) noexcept;
+  static void IncrementCounter(WebViewPreLaunchCounter counter) noexcept;
+  static void RecordError(const std::string& error) noexcept;
+
+  static WebViewPreLaunchMetricsSnapshot Snapshot();
+};
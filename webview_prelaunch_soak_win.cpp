@@ -0,0 +1,354 @@
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "webview_backend_stand_in_win.hpp"
+#include "webview_prelaunch_controller_win.hpp"
+
+// Soak and stress run of Launch -> WaitForLaunch -> Close -> WaitForClose cycles against the
+// stand-in backend, as long-lived hosts recycle their pre-launches.  Several threads each run
+// their own controllers at once, and every cycle closes after a random delay, a quarter of them
+// while the launch is still in flight.  Fails on exceptions, leaked stand-in objects, thread,
+// handle or memory growth after warm-up, or p99 latencies regressing from a baseline.
+
+namespace {
+struct SoakOptions {
+    size_t cycles = 2000;
+    size_t concurrency = 4;
+    // Upper bound of the random time a cycle waits before closing.
+    std::chrono::milliseconds max_close_delay = std::chrono::milliseconds(5);
+    // Upper bound of the stand-in's random environment and controller creation latencies.
+    std::chrono::milliseconds max_creation_latency = std::chrono::milliseconds(3);
+    // Growth tolerated from the end of warm-up to the end of the run.  The OS thread pool and
+    // lazily created system handles account for a few.
+    int64_t max_thread_growth = 2;
+    int64_t max_handle_growth = 32;
+    int64_t max_memory_growth_per_cycle = 512;
+    // Output of an earlier --json run.  A p99 above the baseline's times max_regression, plus a
+    // millisecond of slack for timer resolution, fails.
+    std::filesystem::path baseline_path;
+    double max_regression = 1.5;
+    bool json = false;
+};
+
+enum Operation { kLaunch, kWaitForLaunch, kClose, kWaitForClose, kOperationCount };
+constexpr const char* kOperationNames[kOperationCount] = {"launch", "wait_for_launch", "close", "wait_for_close"};
+
+struct CycleResults {
+    std::array<std::vector<std::chrono::microseconds>, kOperationCount> latencies;
+    size_t cycles = 0;
+    size_t closed_during_launch = 0;
+    std::vector<std::string> errors;
+
+    void Merge(CycleResults&& other) {
+        for (size_t operation = 0; operation < kOperationCount; ++operation) {
+            latencies[operation].insert(latencies[operation].end(), other.latencies[operation].begin(), other.latencies[operation].end());
+        }
+        cycles += other.cycles;
+        closed_during_launch += other.closed_during_launch;
+        errors.insert(errors.end(), other.errors.begin(), other.errors.end());
+    }
+};
+
+struct ResourceUsage {
+    int64_t threads = 0;
+    int64_t handles = 0;
+    int64_t private_bytes = 0;
+};
+
+ResourceUsage MeasureResourceUsage() {
+    ResourceUsage usage;
+
+    wil::unique_hfile snapshot(CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0));
+    THROW_LAST_ERROR_IF(snapshot.get() == INVALID_HANDLE_VALUE);
+    THREADENTRY32 entry = {};
+    entry.dwSize = sizeof(entry);
+    DWORD process_id = GetCurrentProcessId();
+    for (BOOL more = Thread32First(snapshot.get(), &entry); more; more = Thread32Next(snapshot.get(), &entry)) {
+        if (entry.th32OwnerProcessID == process_id) {
+            ++usage.threads;
+        }
+    }
+    // Not counting the snapshot's own handle.
+    snapshot.reset();
+
+    DWORD handles = 0;
+    THROW_IF_WIN32_BOOL_FALSE(GetProcessHandleCount(GetCurrentProcess(), &handles));
+    usage.handles = handles;
+
+    PROCESS_MEMORY_COUNTERS_EX memory = {};
+    THROW_IF_WIN32_BOOL_FALSE(GetProcessMemoryInfo(
+        GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&memory), sizeof(memory)));
+    usage.private_bytes = static_cast<int64_t>(memory.PrivateUsage);
+    return usage;
+}
+
+void RunCycle(const SoakOptions& soak_options,
+              const std::filesystem::path& cache_args_path,
+              std::mt19937& random,
+              CycleResults& results) {
+    std::uniform_int_distribution<int64_t> creation_latency(0, soak_options.max_creation_latency.count());
+    std::uniform_int_distribution<int64_t> close_delay(0, soak_options.max_close_delay.count());
+    bool close_during_launch = random() % 4 == 0;
+    bool wait_for_browser_process_exit = random() % 2 == 0;
+
+    // A backend per cycle, so its counters tell whether this cycle released everything.
+    WebViewStandInBackendOptions backend_options;
+    backend_options.environment_creation_latency = std::chrono::milliseconds(creation_latency(random));
+    backend_options.controller_creation_latency = std::chrono::milliseconds(creation_latency(random));
+    auto backend = std::make_shared<WebViewStandInBackend>(backend_options);
+
+    auto timed = [&results](Operation operation, const std::function<void()>& call) {
+        auto start = std::chrono::steady_clock::now();
+        call();
+        results.latencies[operation].push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+    };
+
+    {
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend);
+        timed(kLaunch, [&]() { controller->Launch(cache_args_path); });
+        if (!close_during_launch) {
+            timed(kWaitForLaunch, [&]() { controller->WaitForLaunch(); });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(close_delay(random)));
+        timed(kClose, [&]() { controller->Close(wait_for_browser_process_exit); });
+        timed(kWaitForClose, [&]() { controller->WaitForClose(); });
+        if (close_during_launch) {
+            // Closing releases anyone waiting for the abandoned launch.
+            controller->WaitForLaunch();
+            ++results.closed_during_launch;
+        }
+
+        for (const auto& exception : controller->GetTelemetry().exceptions) {
+            results.errors.push_back("Launch recorded an exception: " + exception);
+        }
+    }
+
+    const auto& counters = backend->GetCounters();
+    if (counters.live_environments != 0 || counters.live_controllers != 0) {
+        results.errors.push_back("Cycle leaked " + std::to_string(counters.live_environments) + " environments and " +
+                                 std::to_string(counters.live_controllers) + " controllers");
+    }
+    ++results.cycles;
+}
+
+CycleResults RunCycles(const SoakOptions& soak_options, const std::filesystem::path& cache_args_path, size_t cycles) {
+    size_t concurrency = std::max<size_t>(soak_options.concurrency, 1);
+    std::vector<CycleResults> worker_results(concurrency);
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < concurrency; ++worker) {
+        size_t worker_cycles = cycles / concurrency + (worker < cycles % concurrency ? 1 : 0);
+        workers.emplace_back([&soak_options, &cache_args_path, worker_cycles, &results = worker_results[worker]]() {
+            std::mt19937 random(std::random_device{}());
+            for (size_t cycle = 0; cycle < worker_cycles; ++cycle) {
+                RunCycle(soak_options, cache_args_path, random, results);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    CycleResults results;
+    for (auto& worker_result : worker_results) {
+        results.Merge(std::move(worker_result));
+    }
+    return results;
+}
+
+struct LatencySummary {
+    double p50_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+};
+
+LatencySummary Summarize(std::vector<std::chrono::microseconds> latencies) {
+    LatencySummary summary;
+    if (latencies.empty()) {
+        return summary;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    // Nearest rank, as ComputeDistribution does for telemetry.
+    auto percentile = [&latencies](size_t percent) {
+        size_t rank = (percent * latencies.size() + 99) / 100;
+        return latencies[std::max<size_t>(rank, 1) - 1].count() / 1000.0;
+    };
+    summary.p50_ms = percentile(50);
+    summary.p99_ms = percentile(99);
+    summary.max_ms = latencies.back().count() / 1000.0;
+    return summary;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: webview_prelaunch_soak_win [--cycles N] [--concurrency N] [--max-close-delay-ms N]\n"
+                 "                                  [--max-creation-latency-ms N] [--max-thread-growth N]\n"
+                 "                                  [--max-handle-growth N] [--max-memory-growth-per-cycle BYTES]\n"
+                 "                                  [--baseline FILE] [--max-regression FACTOR] [--json]\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    SoakOptions soak_options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        try {
+            if (arg == "--cycles" && has_value) {
+                soak_options.cycles = std::stoul(argv[++i]);
+            } else if (arg == "--concurrency" && has_value) {
+                soak_options.concurrency = std::stoul(argv[++i]);
+            } else if (arg == "--max-close-delay-ms" && has_value) {
+                soak_options.max_close_delay = std::chrono::milliseconds(std::stol(argv[++i]));
+            } else if (arg == "--max-creation-latency-ms" && has_value) {
+                soak_options.max_creation_latency = std::chrono::milliseconds(std::stol(argv[++i]));
+            } else if (arg == "--max-thread-growth" && has_value) {
+                soak_options.max_thread_growth = std::stoll(argv[++i]);
+            } else if (arg == "--max-handle-growth" && has_value) {
+                soak_options.max_handle_growth = std::stoll(argv[++i]);
+            } else if (arg == "--max-memory-growth-per-cycle" && has_value) {
+                soak_options.max_memory_growth_per_cycle = std::stoll(argv[++i]);
+            } else if (arg == "--baseline" && has_value) {
+                soak_options.baseline_path = argv[++i];
+            } else if (arg == "--max-regression" && has_value) {
+                soak_options.max_regression = std::stod(argv[++i]);
+            } else if (arg == "--json") {
+                soak_options.json = true;
+            } else {
+                PrintUsage();
+                return 2;
+            }
+        } catch (const std::invalid_argument&) {
+            PrintUsage();
+            return 2;
+        } catch (const std::out_of_range&) {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    auto temp_path = std::filesystem::temp_directory_path() / "webviewprelaunch_soak";
+    std::filesystem::create_directories(temp_path / "user_data");
+    auto cache_args_path = temp_path / "cache.json";
+    {
+        std::ofstream cache_file(cache_args_path);
+        cache_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+        WebViewCreationArguments args;
+        args.user_data_dir = (temp_path / "user_data").string();
+        args.language = "en-US";
+        args.release_channels_mask = 0xf;
+        WebViewPreLaunchControllerWin::CacheWebViewCreationArguments(cache_file, args);
+    }
+
+    // Warm-up settles one-time allocations, like registered window classes and the CRT's and the
+    // OS's caches, so that growth from here on is growth per cycle.
+    auto results = RunCycles(soak_options, cache_args_path, std::max(soak_options.cycles / 10, soak_options.concurrency));
+    auto errors = std::move(results.errors);
+    auto usage_before = MeasureResourceUsage();
+    results = RunCycles(soak_options, cache_args_path, soak_options.cycles);
+    auto usage_after = MeasureResourceUsage();
+    errors.insert(errors.end(), results.errors.begin(), results.errors.end());
+
+    ResourceUsage growth;
+    growth.threads = usage_after.threads - usage_before.threads;
+    growth.handles = usage_after.handles - usage_before.handles;
+    growth.private_bytes = usage_after.private_bytes - usage_before.private_bytes;
+    double memory_growth_per_cycle = results.cycles > 0 ? static_cast<double>(growth.private_bytes) / results.cycles : 0;
+
+    std::vector<std::string> failures;
+    if (!errors.empty()) {
+        failures.push_back(std::to_string(errors.size()) + " errors, the first: " + errors.front());
+    }
+    if (growth.threads > soak_options.max_thread_growth) {
+        failures.push_back("Thread count grew by " + std::to_string(growth.threads));
+    }
+    if (growth.handles > soak_options.max_handle_growth) {
+        failures.push_back("Handle count grew by " + std::to_string(growth.handles));
+    }
+    if (memory_growth_per_cycle > soak_options.max_memory_growth_per_cycle) {
+        failures.push_back("Private bytes grew by " + std::to_string(growth.private_bytes) + " bytes");
+    }
+
+    std::array<LatencySummary, kOperationCount> summaries;
+    for (size_t operation = 0; operation < kOperationCount; ++operation) {
+        summaries[operation] = Summarize(std::move(results.latencies[operation]));
+    }
+
+    if (!soak_options.baseline_path.empty()) {
+        std::ifstream baseline_file(soak_options.baseline_path);
+        if (!baseline_file.is_open()) {
+            std::cerr << "Failed to open " << soak_options.baseline_path << std::endl;
+            return 2;
+        }
+        nlohmann::json baseline;
+        baseline_file >> baseline;
+        for (size_t operation = 0; operation < kOperationCount; ++operation) {
+            double baseline_p99 = baseline["operations"][kOperationNames[operation]].value("p99_ms", 0.0);
+            if (summaries[operation].p99_ms > baseline_p99 * soak_options.max_regression + 1.0) {
+                std::ostringstream failure;
+                failure << kOperationNames[operation] << " p99 regressed from " << baseline_p99 << " ms to "
+                        << summaries[operation].p99_ms << " ms";
+                failures.push_back(failure.str());
+            }
+        }
+    }
+
+    if (soak_options.json) {
+        nlohmann::json j;
+        j["cycles"] = results.cycles;
+        j["concurrency"] = soak_options.concurrency;
+        j["closed_during_launch"] = results.closed_during_launch;
+        for (size_t operation = 0; operation < kOperationCount; ++operation) {
+            j["operations"][kOperationNames[operation]] = {
+                {"p50_ms", summaries[operation].p50_ms},
+                {"p99_ms", summaries[operation].p99_ms},
+                {"max_ms", summaries[operation].max_ms}
+            };
+        }
+        j["growth"] = {
+            {"threads", growth.threads},
+            {"handles", growth.handles},
+            {"private_bytes", growth.private_bytes}
+        };
+        j["failures"] = failures;
+        std::cout << j.dump(2) << std::endl;
+    } else {
+        std::cout << "Soak: " << results.cycles << " cycles on " << soak_options.concurrency << " threads, "
+                  << results.closed_during_launch << " closed during launch\n"
+                  << "  " << std::left << std::setw(16) << "operation" << std::right
+                  << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << "\n";
+        for (size_t operation = 0; operation < kOperationCount; ++operation) {
+            std::cout << "  " << std::left << std::setw(16) << kOperationNames[operation] << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(9) << summaries[operation].p50_ms << " ms"
+                      << std::setw(9) << summaries[operation].p99_ms << " ms"
+                      << std::setw(9) << summaries[operation].max_ms << " ms\n";
+        }
+        std::cout << "Growth after warm-up: threads " << growth.threads << ", handles " << growth.handles
+                  << ", private bytes " << growth.private_bytes << " (" << std::setprecision(1)
+                  << memory_growth_per_cycle << " per cycle)\n";
+        for (const auto& failure : failures) {
+            std::cout << "FAILED: " << failure << "\n";
+        }
+    }
+    return failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+#include "webview_prelaunch_telemetry_analysis.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+struct Milestone {
+    const char* phase_name;
+    std::chrono::milliseconds offset;
+};
+
+void PrintDistribution(std::ostream& stream, const char* name, const WebViewPreLaunchDistribution& distribution) {
+    stream << "  " << std::left << std::setw(20) << name << std::right
+           << " p50 " << std::setw(6) << distribution.p50.count() << " ms"
+           << "  p90 " << std::setw(6) << distribution.p90.count() << " ms"
+           << "  max " << std::setw(6) << distribution.max.count() << " ms\n";
+}
+
+void AddMilestonePhases(const WebViewPreLaunchTelemetry& telemetry, WebViewPreLaunchAnalysis& analysis) {
+    // Each phase ends at its milestone.  Zero offsets were not recorded and are skipped, so a phase
+    // following a skipped one absorbs its time.  Without recorded launch phases the steps ran in
+    // sequence, so every one of them is on the critical path.
+    const Milestone milestones[] = {
+        {"thread_start", telemetry.background_launch_started},
+        {"read_cached_args", telemetry.read_cached_args_completed},
+        {"create_window", telemetry.window_created},
+        {"create_environment", telemetry.environment_created},
+        {"create_controller", telemetry.controller_created},
+    };
+
+    auto previous_offset = std::chrono::milliseconds::zero();
+    for (const auto& milestone : milestones) {
+        if (milestone.offset == std::chrono::milliseconds::zero()) {
+            continue;
+        }
+
+        analysis.background_phases.push_back({milestone.phase_name, milestone.offset - previous_offset});
+        analysis.critical_path.push_back(milestone.phase_name);
+        previous_offset = milestone.offset;
+    }
+}
+
+void AddLaunchGraphPhases(const WebViewPreLaunchTelemetry& telemetry, WebViewPreLaunchAnalysis& analysis) {
+    const auto& phases = telemetry.launch_phases;
+    if (telemetry.background_launch_started != std::chrono::milliseconds::zero()) {
+        analysis.background_phases.push_back({"thread_start", telemetry.background_launch_started});
+    }
+    // A deferred launch waited for its trigger before running any phase.
+    bool deferred = telemetry.launch_triggered != std::chrono::milliseconds::zero() &&
+                    telemetry.launch_trigger != "immediate";
+    if (deferred) {
+        analysis.background_phases.push_back({"launch_deferred", telemetry.launch_triggered - telemetry.background_launch_started});
+    }
+
+    // The environment is requested by request_environment and completes asynchronously after it.
+    // Phases still running by then don't hold it up.  Telemetry without that phase ends with the
+    // phase that completed last.
+    size_t requesting_phase = 0;
+    bool found_request_environment = false;
+    for (size_t index = 0; index < phases.size(); ++index) {
+        analysis.background_phases.push_back({phases[index].name, phases[index].completed - phases[index].started});
+        if (phases[index].name == "request_environment") {
+            requesting_phase = index;
+            found_request_environment = true;
+        } else if (!found_request_environment && phases[index].completed >= phases[requesting_phase].completed) {
+            requesting_phase = index;
+        }
+    }
+
+    // Walk back from the requesting phase.  A phase waited for its dependencies and for the phases
+    // before it on the same thread, and the one of those completing last held it up.
+    std::vector<std::string> graph_path;
+    std::optional<size_t> current = requesting_phase;
+    while (current.has_value()) {
+        const auto& phase = phases[current.value()];
+        graph_path.push_back(phase.name);
+
+        std::optional<size_t> blocking;
+        for (size_t index = 0; index < current.value(); ++index) {
+            const auto& candidate = phases[index];
+            bool is_dependency = std::find(phase.dependencies.begin(), phase.dependencies.end(), candidate.name) !=
+                                 phase.dependencies.end();
+            bool ran_before_on_thread = candidate.on_worker_thread == phase.on_worker_thread;
+            if ((is_dependency || ran_before_on_thread) &&
+                (!blocking.has_value() || candidate.completed >= phases[blocking.value()].completed)) {
+                blocking = index;
+            }
+        }
+        current = blocking;
+    }
+    if (deferred) {
+        graph_path.push_back("launch_deferred");
+    }
+    if (telemetry.background_launch_started != std::chrono::milliseconds::zero()) {
+        graph_path.push_back("thread_start");
+    }
+    analysis.critical_path.assign(graph_path.rbegin(), graph_path.rend());
+
+    const Milestone milestones[] = {
+        {"create_environment", telemetry.environment_created},
+        {"create_controller", telemetry.controller_created},
+    };
+
+    auto previous_offset = phases[requesting_phase].completed;
+    for (const auto& milestone : milestones) {
+        if (milestone.offset == std::chrono::milliseconds::zero()) {
+            continue;
+        }
+
+        analysis.background_phases.push_back({milestone.phase_name, milestone.offset - previous_offset});
+        analysis.critical_path.push_back(milestone.phase_name);
+        previous_offset = milestone.offset;
+    }
+}
+}  // namespace
+
+WebViewPreLaunchDistribution ComputeDistribution(std::vector<std::chrono::milliseconds> values) {
+    WebViewPreLaunchDistribution distribution;
+    if (values.empty()) {
+        return distribution;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](size_t percent) {
+        size_t rank = (percent * values.size() + 99) / 100;
+        return values[std::max<size_t>(rank, 1) - 1];
+    };
+    distribution.p50 = percentile(50);
+    distribution.p90 = percentile(90);
+    distribution.max = values.back();
+    return distribution;
+}
+
+WebViewPreLaunchAnalysis AnalyzePreLaunchTelemetry(const WebViewPreLaunchTelemetry& telemetry) {
+    WebViewPreLaunchAnalysis analysis;
+
+    if (telemetry.launch_phases.empty()) {
+        AddMilestonePhases(telemetry, analysis);
+    } else {
+        AddLaunchGraphPhases(telemetry, analysis);
+    }
+
+    auto slowest = std::chrono::milliseconds(-1);
+    for (const auto& phase : analysis.background_phases) {
+        if (phase.duration > slowest) {
+            slowest = phase.duration;
+            analysis.slowest_background_phase = phase.name;
+        }
+    }
+
+    if (telemetry.ready != std::chrono::milliseconds::zero()) {
+        analysis.launch_succeeded = true;
+        analysis.ready = telemetry.ready;
+        analysis.non_fatal_exceptions = telemetry.exceptions.size();
+    } else if (telemetry.controller_created != std::chrono::milliseconds::zero() && telemetry.exceptions.empty()) {
+        // Older telemetry without readiness.  controller_created is recorded for failed creations
+        // too, so only a launch without exceptions can be told to have succeeded.
+        analysis.launch_succeeded = true;
+        analysis.ready = telemetry.controller_created;
+    }
+
+    bool waited_for_launch = telemetry.waitforlaunch_completed != std::chrono::milliseconds::zero();
+    if (waited_for_launch) {
+        analysis.foreground_blocked = telemetry.waitforlaunch_completed - telemetry.waitforlaunch_started;
+    }
+
+    if (analysis.launch_succeeded) {
+        if (waited_for_launch && analysis.ready > std::chrono::milliseconds::zero()) {
+            auto overlapped = std::min(analysis.ready, telemetry.waitforlaunch_started);
+            analysis.overlap_ratio = static_cast<double>(overlapped.count()) / analysis.ready.count();
+        }
+        // Time a deferred launch spent waiting for its trigger isn't work the host would have done.
+        auto deferred = std::chrono::milliseconds::zero();
+        for (const auto& phase : analysis.background_phases) {
+            if (phase.name == "launch_deferred") {
+                deferred = phase.duration;
+            }
+        }
+        analysis.estimated_saving = std::max(analysis.ready - deferred - analysis.foreground_blocked, std::chrono::milliseconds::zero());
+    }
+
+    return analysis;
+}
+
+WebViewPreLaunchBatchAnalysis AnalyzePreLaunchTelemetry(const std::vector<WebViewPreLaunchTelemetry>& batch) {
+    WebViewPreLaunchBatchAnalysis batch_analysis;
+    batch_analysis.runs = batch.size();
+
+    std::vector<std::chrono::milliseconds> ready;
+    std::vector<std::chrono::milliseconds> foreground_blocked;
+    std::vector<std::chrono::milliseconds> estimated_saving;
+    double overlap_ratio_sum = 0;
+    size_t overlap_ratio_count = 0;
+    for (const auto& telemetry : batch) {
+        auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+        if (telemetry.cache_miss_reason == "runtime_changed") {
+            ++batch_analysis.runtime_changed_runs;
+        }
+        if (analysis.non_fatal_exceptions > 0) {
+            ++batch_analysis.runs_with_non_fatal_exceptions;
+        }
+        if (analysis.launch_succeeded) {
+            ready.push_back(analysis.ready);
+            foreground_blocked.push_back(analysis.foreground_blocked);
+            estimated_saving.push_back(analysis.estimated_saving);
+            if (analysis.overlap_ratio.has_value()) {
+                overlap_ratio_sum += analysis.overlap_ratio.value();
+                ++overlap_ratio_count;
+            }
+        } else {
+            ++batch_analysis.failed_runs;
+        }
+        batch_analysis.run_analyses.push_back(std::move(analysis));
+    }
+
+    batch_analysis.ready = ComputeDistribution(std::move(ready));
+    batch_analysis.foreground_blocked = ComputeDistribution(std::move(foreground_blocked));
+    batch_analysis.estimated_saving = ComputeDistribution(std::move(estimated_saving));
+    if (overlap_ratio_count > 0) {
+        batch_analysis.mean_overlap_ratio = overlap_ratio_sum / overlap_ratio_count;
+    }
+    return batch_analysis;
+}
+
+void PrintPreLaunchAnalysis(std::ostream& stream, const WebViewPreLaunchAnalysis& analysis) {
+    stream << "Background launch phases:\n";
+    for (const auto& phase : analysis.background_phases) {
+        stream << "  " << std::left << std::setw(20) << phase.name << std::right
+               << std::setw(6) << phase.duration.count() << " ms"
+               << (phase.name == analysis.slowest_background_phase ? "  <- slowest" : "") << "\n";
+    }
+
+    stream << "Critical path:          ";
+    for (size_t index = 0; index < analysis.critical_path.size(); ++index) {
+        stream << (index > 0 ? " -> " : "") << analysis.critical_path[index];
+    }
+    stream << "\n";
+
+    if (!analysis.launch_succeeded) {
+        stream << "Launch did not succeed.\n";
+        return;
+    }
+
+    stream << "Ready after:            " << analysis.ready.count() << " ms\n"
+           << "Foreground blocked:     " << analysis.foreground_blocked.count() << " ms\n"
+           << "Overlap ratio:          ";
+    if (analysis.overlap_ratio.has_value()) {
+        stream << std::fixed << std::setprecision(2) << analysis.overlap_ratio.value() << "\n";
+    } else {
+        stream << "n/a\n";
+    }
+    stream << "Estimated saving:       " << analysis.estimated_saving.count() << " ms\n"
+           << "Non-fatal exceptions:   " << analysis.non_fatal_exceptions << "\n";
+}
+
+void PrintPreLaunchAnalysis(std::ostream& stream, const WebViewPreLaunchBatchAnalysis& analysis) {
+    stream << "Runs: " << analysis.runs << " (" << analysis.failed_runs << " failed, "
+           << analysis.runs_with_non_fatal_exceptions << " with non-fatal exceptions, "
+           << analysis.runtime_changed_runs << " on an updated runtime)\n";
+    PrintDistribution(stream, "ready", analysis.ready);
+    PrintDistribution(stream, "foreground_blocked", analysis.foreground_blocked);
+    PrintDistribution(stream, "estimated_saving", analysis.estimated_saving);
+    stream << "  mean overlap ratio   ";
+    if (analysis.mean_overlap_ratio.has_value()) {
+        stream << std::fixed << std::setprecision(2) << analysis.mean_overlap_ratio.value() << "\n";
+    } else {
+        stream << "n/a\n";
+    }
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchPhase& phase) {
+    j = nlohmann::json{
+        {"name", phase.name},
+        {"duration", phase.duration.count()}
+    };
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchAnalysis& analysis) {
+    j = nlohmann::json{
+        {"background_phases", analysis.background_phases},
+        {"slowest_background_phase", analysis.slowest_background_phase},
+        {"critical_path", analysis.critical_path},
+        {"launch_succeeded", analysis.launch_succeeded},
+        {"non_fatal_exceptions", analysis.non_fatal_exceptions},
+        {"ready", analysis.ready.count()},
+        {"foreground_blocked", analysis.foreground_blocked.count()},
+        {"overlap_ratio", nullptr},
+        {"estimated_saving", analysis.estimated_saving.count()}
+    };
+    if (analysis.overlap_ratio.has_value()) {
+        j["overlap_ratio"] = analysis.overlap_ratio.value();
+    }
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchDistribution& distribution) {
+    j = nlohmann::json{
+        {"p50", distribution.p50.count()},
+        {"p90", distribution.p90.count()},
+        {"max", distribution.max.count()}
+    };
+}
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchBatchAnalysis& analysis) {
+    j = nlohmann::json{
+        {"runs", analysis.runs},
+        {"failed_runs", analysis.failed_runs},
+        {"runs_with_non_fatal_exceptions", analysis.runs_with_non_fatal_exceptions},
+        {"runtime_changed_runs", analysis.runtime_changed_runs},
+        {"ready", analysis.ready},
+        {"foreground_blocked", analysis.foreground_blocked},
+        {"estimated_saving", analysis.estimated_saving},
+        {"mean_overlap_ratio", nullptr},
+        {"run_analyses", analysis.run_analyses}
+    };
+    if (analysis.mean_overlap_ratio.has_value()) {
+        j["mean_overlap_ratio"] = analysis.mean_overlap_ratio.value();
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "webview_prelaunch_controller.hpp"
+
+struct WebViewPreLaunchPhase {
+  std::string name;
+  std::chrono::milliseconds duration = std::chrono::milliseconds::zero();
+};
+
+// Step times derived from one run's telemetry, whose fields are offsets from launch_start.
+struct WebViewPreLaunchAnalysis {
+  // Steps of the background launch up to being ready.  When the telemetry recorded launch phases
+  // these are the phases followed by environment and controller creation, otherwise the steps
+  // between consecutive recorded milestones.
+  std::vector<WebViewPreLaunchPhase> background_phases;
+  std::string slowest_background_phase;
+  // The chain of steps that determined when the launch was ready.  Phases that overlapped with it
+  // and finished earlier aren't on it, so speeding them up wouldn't make the launch ready sooner.
+  std::vector<std::string> critical_path;
+  // The launch got ready.  Telemetry from before readiness was recorded counts launches whose
+  // controller was created without any exception.
+  bool launch_succeeded = false;
+  // Exceptions recorded by a launch that still succeeded, e.g. a failed warm-up URL or pool refill.
+  size_t non_fatal_exceptions = 0;
+  // Offset at which the pre-launched controller was ready.  Zero if it never got there.
+  std::chrono::milliseconds ready = std::chrono::milliseconds::zero();
+  // Time the foreground spent blocked in WaitForLaunch.
+  std::chrono::milliseconds foreground_blocked = std::chrono::milliseconds::zero();
+  // Share of the background launch, from 0 to 1, that ran while the foreground did its own work
+  // rather than waiting for it.  Unset when WaitForLaunch wasn't recorded or the launch failed.
+  std::optional<double> overlap_ratio;
+  // Foreground time saved compared with no pre-launch, where the host would create the WebView2
+  // itself after its own startup work and wait for all of it.
+  std::chrono::milliseconds estimated_saving = std::chrono::milliseconds::zero();
+};
+
+struct WebViewPreLaunchDistribution {
+  std::chrono::milliseconds p50 = std::chrono::milliseconds::zero();
+  std::chrono::milliseconds p90 = std::chrono::milliseconds::zero();
+  std::chrono::milliseconds max = std::chrono::milliseconds::zero();
+};
+
+struct WebViewPreLaunchBatchAnalysis {
+  size_t runs = 0;
+  size_t failed_runs = 0;
+  // Runs that succeeded but recorded non-fatal exceptions.
+  size_t runs_with_non_fatal_exceptions = 0;
+  // Runs that found the runtime updated since the previous launch, and so started cold.
+  size_t runtime_changed_runs = 0;
+  // The distributions only cover runs whose launch succeeded.
+  WebViewPreLaunchDistribution ready;
+  WebViewPreLaunchDistribution foreground_blocked;
+  WebViewPreLaunchDistribution estimated_saving;
+  std::optional<double> mean_overlap_ratio;
+  std::vector<WebViewPreLaunchAnalysis> run_analyses;
+};
+
+// Nearest-rank percentiles of |values|.
+WebViewPreLaunchDistribution ComputeDistribution(std::vector<std::chrono::milliseconds> values);
+
+WebViewPreLaunchAnalysis AnalyzePreLaunchTelemetry(const WebViewPreLaunchTelemetry& telemetry);
+WebViewPreLaunchBatchAnalysis AnalyzePreLaunchTelemetry(const std::vector<WebViewPreLaunchTelemetry>& batch);
+
+void PrintPreLaunchAnalysis(std::ostream& stream, const WebViewPreLaunchAnalysis& analysis);
+void PrintPreLaunchAnalysis(std::ostream& stream, const WebViewPreLaunchBatchAnalysis& analysis);
+
+void to_json(nlohmann::json& j, const WebViewPreLaunchPhase& phase);
+void to_json(nlohmann::json& j, const WebViewPreLaunchAnalysis& analysis);
+void to_json(nlohmann::json& j, const WebViewPreLaunchDistribution& distribution);
+void to_json(nlohmann::json& j, const WebViewPreLaunchBatchAnalysis& analysis);
@@ -1,8 +1,26 @@
+#include <winsock2.h>
 #include <gtest/gtest.h>
+#include <boost/nowide/cstdlib.hpp>
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <semaphore>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "webview_args_source.hpp"
+#include "webview_args_source_win.hpp"
+#include "webview_backend_stand_in_win.hpp"
+#include "webview_launch_graph.hpp"
+#include "webview_multi_prelaunch_controller_win.hpp"
 #include "webview_prelaunch_controller.hpp"
 #include "webview_prelaunch_controller_win.hpp"
+#include "webview_prelaunch_metrics.hpp"
+#include "webview_prelaunch_telemetry_analysis.hpp"
+#include "webview_runtime_identity.hpp"
 
 namespace {
     // Helper method to get a temp path for the prelaunch config
@@ -23,6 +41,102 @@ namespace {
 
         return temp_path;
     }
+
+    // Helper method to cache args for a fresh user data dir and return the cache path
+    std::filesystem::path CreateTempPrelaunchConfig() {
+        auto prelaunch_config_path = CreateTempPrelaunchConfigPath();
+        std::ofstream prelaunch_config(prelaunch_config_path);
+        prelaunch_config.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+        WebViewCreationArguments args;
+        args.user_data_dir = CreateTempUserDataPath().string();
+        args.language = "en-US";
+        args.release_channels_mask = 0xf;
+        WebViewPreLaunchControllerWin::CacheWebViewCreationArguments(prelaunch_config, args);
+
+        return prelaunch_config_path;
+    }
+
+    // Minimal HTTP server on the loopback interface so warm-up runs without external network.
+    // Every path serves a small page, except /hang which never answers until the server stops.
+    class LocalHttpServer {
+    public:
+        LocalHttpServer() {
+            WSADATA wsa_data;
+            WSAStartup(MAKEWORD(2, 2), &wsa_data);
+
+            listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            bind(listen_socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            listen(listen_socket_, SOMAXCONN);
+
+            int address_length = sizeof(address);
+            getsockname(listen_socket_, reinterpret_cast<sockaddr*>(&address), &address_length);
+            port_ = ntohs(address.sin_port);
+
+            accept_thread_ = std::thread([this]() { AcceptConnections(); });
+        }
+
+        ~LocalHttpServer() {
+            stopping_ = true;
+            closesocket(listen_socket_);
+            accept_thread_.join();
+            for (auto& connection_thread : connection_threads_) {
+                connection_thread.join();
+            }
+            WSACleanup();
+        }
+
+        std::string Url(const std::string& path) const {
+            return "http://127.0.0.1:" + std::to_string(port_) + path;
+        }
+
+        uint32_t GetRequestCount() const {
+            return request_count_;
+        }
+
+    private:
+        void AcceptConnections() {
+            while (true) {
+                SOCKET connection = accept(listen_socket_, nullptr, nullptr);
+                if (connection == INVALID_SOCKET) {
+                    return;
+                }
+                connection_threads_.emplace_back([this, connection]() { ServeConnection(connection); });
+            }
+        }
+
+        void ServeConnection(SOCKET connection) {
+            char request[4096] = {};
+            int received = recv(connection, request, sizeof(request) - 1, 0);
+            if (received > 0) {
+                ++request_count_;
+                if (std::string(request, received).starts_with("GET /hang ")) {
+                    while (!stopping_) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    }
+                } else {
+                    const std::string body = "<html><body>warm</body></html>";
+                    const std::string response =
+                        "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nCache-Control: max-age=3600\r\n"
+                        "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+                    send(connection, response.c_str(), static_cast<int>(response.size()), 0);
+                }
+            }
+            shutdown(connection, SD_BOTH);
+            closesocket(connection);
+        }
+
+        SOCKET listen_socket_ = INVALID_SOCKET;
+        uint16_t port_ = 0;
+        std::atomic<bool> stopping_ = false;
+        std::atomic<uint32_t> request_count_ = 0;
+        std::thread accept_thread_;
+        std::vector<std::thread> connection_threads_;
+    };
 }
 
 TEST(PreLaunchTest, CacheAndReadWebViewCreationArguments) {
@@ -254,8 +368,11 @@ TEST(PreLaunchTest, LaunchTelemetry) {
     controller->WaitForClose();
 
     const auto& telemetry = controller->GetTelemetry();
+    // The args are read on a worker while the window is created, so the two can finish in either
+    // order, but the environment waits for both.
     ASSERT_TRUE(telemetry.background_launch_started.count() <= telemetry.read_cached_args_completed.count());
-    ASSERT_TRUE(telemetry.read_cached_args_completed.count() <= telemetry.window_created.count());
+    ASSERT_TRUE(telemetry.background_launch_started.count() <= telemetry.window_created.count());
+    ASSERT_TRUE(telemetry.read_cached_args_completed.count() <= telemetry.environment_created.count());
     ASSERT_TRUE(telemetry.window_created.count() <= telemetry.environment_created.count());
     ASSERT_TRUE(telemetry.environment_created.count() <= telemetry.controller_created.count());
     
@@ -291,4 +408,958 @@ TEST(PreLaunchTest, CloseOnDestruct) {
 
     // Test will fail if the destructor does not call join the prelaunch thread
     controller.reset();
-}
\ No newline at end of file
+}
+
+TEST(PreLaunchTest, LaunchWithControllerPool) {
+    auto prelaunch_config_path = CreateTempPrelaunchConfig();
+
+    WebViewPreLaunchOptions options;
+    options.controller_pool.controllers_per_profile = 1;
+    options.controller_pool.profile_names = {"", "Secondary"};
+
+    auto controller = WebViewPreLaunchController::Launch(prelaunch_config_path, options);
+    controller->WaitForLaunch();
+    auto controller_win = static_cast<WebViewPreLaunchControllerWin*>(controller.get());
+
+    std::binary_semaphore acquired(0);
+    bool acquired_controller = false;
+    EXPECT_TRUE(controller_win->AcquirePooledController("Secondary", nullptr,
+        [&acquired, &acquired_controller](std::shared_ptr<WebViewBackendController> pooled_controller) {
+            acquired_controller = pooled_controller != nullptr && pooled_controller->GetCoreWebView2Controller() != nullptr;
+            if (pooled_controller != nullptr) {
+                pooled_controller->Close();
+            }
+            acquired.release();
+        }));
+    acquired.acquire();
+    EXPECT_TRUE(acquired_controller);
+
+    EXPECT_FALSE(controller_win->AcquirePooledController("Unknown", nullptr,
+        [](std::shared_ptr<WebViewBackendController>) {}));
+
+    controller->Close(true);
+    controller->WaitForClose();
+
+    const auto& telemetry = controller->GetTelemetry();
+    EXPECT_EQ(telemetry.controller_pool_hits, 1U);
+    EXPECT_EQ(telemetry.controller_pool_misses, 1U);
+    EXPECT_EQ(telemetry.exceptions.size(), 0U);
+}
+
+TEST(PreLaunchTest, Adopt) {
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>();
+    controller->Launch(CreateTempPrelaunchConfig());
+    controller->WaitForLaunch();
+
+    std::binary_semaphore adopted(0);
+    bool adopted_webview2 = false;
+    EXPECT_TRUE(controller->Adopt(nullptr,
+        [&adopted, &adopted_webview2](std::shared_ptr<WebViewBackendEnvironment> environment,
+                                      std::shared_ptr<WebViewBackendController> webview_controller) {
+            adopted_webview2 = environment->GetCoreWebView2Environment() != nullptr &&
+                               webview_controller->GetCoreWebView2Controller() != nullptr;
+            adopted.release();
+        }));
+    adopted.acquire();
+    EXPECT_TRUE(adopted_webview2);
+
+    controller->Close(false);
+    controller->WaitForClose();
+    EXPECT_EQ(controller->GetTelemetry().exceptions.size(), 0U);
+}
+
+TEST(PreLaunchStandInTest, Adopt) {
+    auto backend = std::make_shared<WebViewStandInBackend>();
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend);
+    controller->Launch(CreateTempPrelaunchConfig());
+    controller->WaitForLaunch();
+    EXPECT_EQ(controller->GetBrowserProcessId(), 1U);
+
+    // Any window will do as a parent, the stand-in only records it.
+    HWND host_window = reinterpret_cast<HWND>(static_cast<intptr_t>(0x1234));
+    std::binary_semaphore adopted(0);
+    HWND adopted_parent = nullptr;
+    EXPECT_TRUE(controller->Adopt(host_window,
+        [&adopted, &adopted_parent](std::shared_ptr<WebViewBackendEnvironment> environment,
+                                    std::shared_ptr<WebViewBackendController> webview_controller) {
+            adopted_parent = webview_controller->GetParentWindow();
+            adopted.release();
+        }));
+    adopted.acquire();
+    EXPECT_EQ(adopted_parent, host_window);
+
+    // The tree can only be handed out once.
+    EXPECT_FALSE(controller->Adopt(host_window, [](auto, auto) {}));
+
+    // Adopting takes the second environment and controller creation off the host's path.
+    EXPECT_EQ(backend->GetCounters().environments_created, 1U);
+    EXPECT_EQ(backend->GetCounters().controllers_created, 1U);
+
+    controller->Close(true);
+    controller->WaitForClose();
+    EXPECT_EQ(controller->GetTelemetry().exceptions.size(), 0U);
+    EXPECT_EQ(backend->GetCounters().live_environments, 0);
+    EXPECT_EQ(backend->GetCounters().live_controllers, 0);
+}
+
+TEST(PreLaunchStandInTest, AdoptAfterFailedLaunch) {
+    WebViewStandInBackendOptions backend_options;
+    backend_options.environment_creation_result = E_FAIL;
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>(backend_options));
+    controller->Launch(CreateTempPrelaunchConfig());
+    controller->WaitForLaunch();
+
+    EXPECT_FALSE(controller->Adopt(nullptr, [](auto, auto) {}));
+    EXPECT_EQ(controller->GetTelemetry().exceptions.size(), 1U);
+
+    controller->Close(false);
+    controller->WaitForClose();
+}
+
+TEST(PreLaunchTest, EnvironmentOptionsSnapshot) {
+    WebViewCreationArguments args;
+    args.user_data_dir = "C:\\test\\user_data";
+    args.additional_browser_arguments = "--test-arg";
+    args.language = "en-US";
+
+    auto options = WebViewEnvironmentOptions::Get(args);
+    EXPECT_EQ(options, WebViewEnvironmentOptions::Get(args));
+    EXPECT_EQ(options->GetUserDataDir(), L"C:\\test\\user_data");
+    EXPECT_EQ(options->GetFingerprint(), WebViewEnvironmentOptions::ComputeFingerprint(args));
+
+    WebViewCreationArguments other_args = args;
+    other_args.enable_tracking_prevention = true;
+    auto other_options = WebViewEnvironmentOptions::Get(other_args);
+    EXPECT_NE(options, other_options);
+    EXPECT_NE(options->GetFingerprint(), other_options->GetFingerprint());
+    EXPECT_FALSE(options->Matches(*other_options));
+}
+
+TEST(PreLaunchStandInTest, HostSharesEnvironmentOptions) {
+    auto prelaunch_config_path = CreateTempPrelaunchConfig();
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>());
+    controller->Launch(prelaunch_config_path);
+    controller->WaitForLaunch();
+
+    // A host building options from the same args gets the snapshot the pre-launch used.
+    auto cached_args = controller->ReadCachedWebViewCreationArguments(prelaunch_config_path);
+    ASSERT_TRUE(cached_args.has_value());
+    EXPECT_EQ(WebViewEnvironmentOptions::Get(cached_args.value()), controller->GetEnvironmentOptions());
+
+    controller->Close(false);
+    controller->WaitForClose();
+}
+
+TEST(PreLaunchTest, WarmUp) {
+    LocalHttpServer server;
+
+    WebViewPreLaunchOptions options;
+    options.warm_up.urls = {server.Url("/first.html"), server.Url("/second.html")};
+    options.warm_up.before_ready = true;
+
+    auto controller = WebViewPreLaunchController::Launch(CreateTempPrelaunchConfig(), options);
+    controller->WaitForLaunch();
+
+    const auto& telemetry = controller->GetTelemetry();
+    ASSERT_EQ(telemetry.warm_up.size(), 2U);
+    EXPECT_EQ(telemetry.warm_up[0].url, server.Url("/first.html"));
+    EXPECT_TRUE(telemetry.warm_up[0].succeeded);
+    EXPECT_TRUE(telemetry.warm_up[1].succeeded);
+    EXPECT_TRUE(telemetry.warm_up[0].started.count() <= telemetry.warm_up[1].started.count());
+    EXPECT_TRUE(telemetry.controller_created.count() <= telemetry.warm_up_completed.count());
+    EXPECT_GE(server.GetRequestCount(), 2U);
+
+    controller->Close(true);
+    controller->WaitForClose();
+    EXPECT_EQ(telemetry.exceptions.size(), 0U);
+}
+
+TEST(PreLaunchTest, WarmUpBudget) {
+    LocalHttpServer server;
+
+    WebViewPreLaunchOptions options;
+    options.warm_up.urls = {server.Url("/hang"), server.Url("/after.html")};
+    options.warm_up.per_url_budget = std::chrono::milliseconds(500);
+    options.warm_up.before_ready = true;
+
+    auto controller = WebViewPreLaunchController::Launch(CreateTempPrelaunchConfig(), options);
+    controller->WaitForLaunch();
+
+    const auto& telemetry = controller->GetTelemetry();
+    ASSERT_EQ(telemetry.warm_up.size(), 2U);
+    EXPECT_TRUE(telemetry.warm_up[0].timed_out);
+    EXPECT_FALSE(telemetry.warm_up[0].succeeded);
+    EXPECT_FALSE(telemetry.warm_up[1].timed_out);
+    EXPECT_TRUE(telemetry.warm_up[1].succeeded);
+
+    controller->Close(true);
+    controller->WaitForClose();
+}
+
+TEST(PreLaunchStandInTest, WarmUpFromFile) {
+    auto urls_path = CreateTempPrelaunchConfigPath().replace_filename("warm_up_urls.txt");
+    std::ofstream urls_file(urls_path);
+    urls_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    urls_file << "https://example.invalid/a\n\nhttps://example.invalid/b\n";
+    urls_file.close();
+
+    WebViewStandInBackendOptions backend_options;
+    backend_options.navigation_latency = std::chrono::milliseconds(20);
+    auto backend = std::make_shared<WebViewStandInBackend>(backend_options);
+
+    WebViewPreLaunchOptions options;
+    options.warm_up.urls_file = urls_path;
+    options.warm_up.before_ready = true;
+
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend);
+    controller->Launch(CreateTempPrelaunchConfig(), options);
+    controller->WaitForLaunch();
+
+    EXPECT_EQ(backend->GetCounters().navigations, 2U);
+    ASSERT_EQ(controller->GetTelemetry().warm_up.size(), 2U);
+    EXPECT_EQ(controller->GetTelemetry().warm_up[1].url, "https://example.invalid/b");
+
+    controller->Close(false);
+    controller->WaitForClose();
+}
+
+TEST(LaunchGraphTest, OverlapsIndependentPhases) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.launch_start = std::chrono::high_resolution_clock::now();
+
+    // The worker phase can only finish once the launch thread phase has started, so this would
+    // deadlock if they didn't run concurrently.
+    std::binary_semaphore launch_thread_phase_started(0);
+    std::thread::id worker_thread_id;
+    std::vector<std::string> order;
+    std::mutex order_mutex;
+    auto record = [&order, &order_mutex](const char* name) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(name);
+    };
+
+    WebViewLaunchGraph launch_graph;
+    launch_graph.AddPhase("read", {}, /*off_launch_thread*/true, [&]() {
+        worker_thread_id = std::this_thread::get_id();
+        launch_thread_phase_started.acquire();
+        record("read");
+    });
+    launch_graph.AddPhase("window", {}, /*off_launch_thread*/false, [&]() {
+        launch_thread_phase_started.release();
+        record("window");
+    });
+    launch_graph.AddPhase("environment", {"read", "window"}, /*off_launch_thread*/false, [&]() {
+        record("environment");
+    });
+    launch_graph.Run(/*overlap*/true, telemetry);
+
+    EXPECT_NE(worker_thread_id, std::this_thread::get_id());
+    ASSERT_EQ(order.size(), 3U);
+    EXPECT_EQ(order[2], "environment");
+
+    ASSERT_EQ(telemetry.launch_phases.size(), 3U);
+    EXPECT_TRUE(telemetry.launch_phases[0].on_worker_thread);
+    EXPECT_FALSE(telemetry.launch_phases[1].on_worker_thread);
+    EXPECT_EQ(telemetry.launch_phases[2].dependencies, (std::vector<std::string>{"read", "window"}));
+}
+
+TEST(LaunchGraphTest, SequentialAndFailures) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.launch_start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::string> order;
+    WebViewLaunchGraph launch_graph;
+    launch_graph.AddPhase("read", {}, /*off_launch_thread*/true, [&order]() {
+        order.push_back("read");
+        throw std::runtime_error("read failed");
+    });
+    launch_graph.AddPhase("options", {"read"}, /*off_launch_thread*/true, [&order]() { order.push_back("options"); });
+    launch_graph.AddPhase("window", {}, /*off_launch_thread*/false, [&order]() { order.push_back("window"); });
+    EXPECT_THROW(launch_graph.AddPhase("environment", {"unknown"}, false, []() {}), std::invalid_argument);
+
+    // Phases run in the order added on the calling thread, and ones depending on a failure are skipped.
+    EXPECT_THROW(launch_graph.Run(/*overlap*/false, telemetry), std::runtime_error);
+    EXPECT_EQ(order, (std::vector<std::string>{"read", "window"}));
+    ASSERT_EQ(telemetry.launch_phases.size(), 2U);
+    EXPECT_EQ(telemetry.launch_phases[1].name, "window");
+    EXPECT_FALSE(telemetry.launch_phases[0].on_worker_thread);
+}
+
+TEST(PreLaunchStandInTest, LaunchPhases) {
+    for (bool overlap : {true, false}) {
+        WebViewPreLaunchOptions options;
+        options.overlap_launch_phases = overlap;
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>());
+        controller->Launch(CreateTempPrelaunchConfig(), options);
+        controller->WaitForLaunch();
+
+        const auto& telemetry = controller->GetTelemetry();
+        ASSERT_EQ(telemetry.launch_phases.size(), 5U);
+        EXPECT_EQ(telemetry.launch_phases[0].name, "read_cached_args");
+        EXPECT_EQ(telemetry.launch_phases[0].on_worker_thread, overlap);
+        EXPECT_EQ(telemetry.launch_phases[4].name, "request_environment");
+        EXPECT_LE(telemetry.launch_phases[4].completed, telemetry.environment_created);
+
+        auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+        EXPECT_TRUE(analysis.launch_succeeded);
+        EXPECT_EQ(analysis.critical_path.back(), "create_controller");
+
+        controller->Close(false);
+        controller->WaitForClose();
+        EXPECT_EQ(telemetry.exceptions.size(), 0U);
+    }
+}
+
+TEST(PreLaunchStandInTest, SlowRuntimeResolution) {
+    // Resolving the runtime takes longer than the whole launch, which doesn't wait for it.
+    WebViewStandInBackendOptions backend_options;
+    backend_options.runtime_resolution_latency = std::chrono::milliseconds(1000);
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>(backend_options));
+    controller->Launch(CreateTempPrelaunchConfig());
+    controller->WaitForLaunch();
+
+    const auto& telemetry = controller->GetTelemetry();
+    EXPECT_LT(telemetry.environment_created, backend_options.runtime_resolution_latency);
+    EXPECT_LT(telemetry.ready, backend_options.runtime_resolution_latency);
+
+    // Teardown waits for the runtime to be resolved and recorded.
+    controller->Close(false);
+    controller->WaitForClose();
+    EXPECT_EQ(telemetry.runtime_version, "1.0.0.0");
+    EXPECT_EQ(telemetry.exceptions.size(), 0U);
+}
+
+TEST(PreLaunchStandInTest, ArgsSources) {
+    WebViewCreationArguments args;
+    args.user_data_dir = CreateTempUserDataPath().string();
+    args.language = "de-DE";
+    args.release_channels_mask = 0xf;
+
+    auto launch = [](auto&& args_or_source) {
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>());
+        controller->Launch(args_or_source);
+        controller->WaitForLaunch();
+        controller->Close(false);
+        controller->WaitForClose();
+        EXPECT_EQ(controller->GetTelemetry().exceptions.size(), 0U);
+        return controller;
+    };
+
+    auto controller = launch(args);
+    EXPECT_EQ(controller->GetTelemetry().args_source, "in_memory");
+    // A copy isn't worth a worker thread.
+    ASSERT_FALSE(controller->GetTelemetry().launch_phases.empty());
+    EXPECT_FALSE(controller->GetTelemetry().launch_phases[0].on_worker_thread);
+    EXPECT_EQ(controller->GetEnvironmentOptions()->GetArgs(), args);
+    // Without a cache file there is nowhere to record the runtime, and nothing to miss.
+    EXPECT_EQ(controller->GetTelemetry().cache_miss_reason, "");
+    EXPECT_EQ(controller->GetTelemetry().runtime_version, "1.0.0.0");
+
+    auto prelaunch_config_path = CreateTempPrelaunchConfigPath();
+    {
+        std::ofstream prelaunch_config(prelaunch_config_path);
+        WebViewPreLaunchControllerWin::CacheWebViewCreationArguments(prelaunch_config, args);
+    }
+    controller = launch(prelaunch_config_path);
+    EXPECT_EQ(controller->GetTelemetry().args_source, "json_file");
+    EXPECT_TRUE(controller->GetTelemetry().launch_phases[0].on_worker_thread);
+    EXPECT_EQ(controller->GetEnvironmentOptions()->GetArgs(), args);
+
+    controller = launch(std::make_shared<WebViewMappedFileArgsSource>(prelaunch_config_path));
+    EXPECT_EQ(controller->GetTelemetry().args_source, "mapped_file");
+    EXPECT_EQ(controller->GetEnvironmentOptions()->GetArgs(), args);
+}
+
+TEST(PreLaunchTest, EnvironmentArgsSource) {
+    WebViewEnvironmentArgsSource args_source("WEBVIEW_PRELAUNCH_TEST_");
+    EXPECT_THROW(args_source.Read(), std::runtime_error);
+
+    boost::nowide::setenv("WEBVIEW_PRELAUNCH_TEST_USER_DATA_DIR", "C:\\user data", 1);
+    boost::nowide::setenv("WEBVIEW_PRELAUNCH_TEST_RELEASE_CHANNELS_MASK", "15", 1);
+    boost::nowide::setenv("WEBVIEW_PRELAUNCH_TEST_ENABLE_TRACKING_PREVENTION", "true", 1);
+    auto args = args_source.Read();
+    EXPECT_EQ(args.user_data_dir, "C:\\user data");
+    EXPECT_EQ(args.release_channels_mask, 15);
+    EXPECT_TRUE(args.enable_tracking_prevention);
+    EXPECT_EQ(args.language, "");
+
+    boost::nowide::setenv("WEBVIEW_PRELAUNCH_TEST_RELEASE_CHANNELS_MASK", "300", 1);
+    EXPECT_THROW(args_source.Read(), std::out_of_range);
+
+    boost::nowide::unsetenv("WEBVIEW_PRELAUNCH_TEST_USER_DATA_DIR");
+    boost::nowide::unsetenv("WEBVIEW_PRELAUNCH_TEST_RELEASE_CHANNELS_MASK");
+    boost::nowide::unsetenv("WEBVIEW_PRELAUNCH_TEST_ENABLE_TRACKING_PREVENTION");
+}
+
+TEST(PreLaunchTest, RuntimeIdentityUtf8Path) {
+    WebViewRuntimeIdentity identity;
+    identity.executable_path = L"C:\\Users\\J\u00fcrgen\\\u30a2\u30d7\u30ea\\msedgewebview2.exe";
+    identity.version = "1.0.0.0";
+
+    nlohmann::json j = identity;
+    EXPECT_EQ(j["executable_path"], "C:\\Users\\J\xc3\xbcrgen\\\xe3\x82\xa2\xe3\x83\x97\xe3\x83\xaa\\msedgewebview2.exe");
+    EXPECT_EQ(j.get<WebViewRuntimeIdentity>(), identity);
+}
+
+TEST(PreLaunchStandInTest, RuntimeChange) {
+    // Runtimes laid out like the evergreen runtime's, one folder per version.
+    auto prelaunch_config_path = CreateTempPrelaunchConfig();
+    auto runtime_root = prelaunch_config_path.parent_path() / "Application";
+    auto install_runtime = [&runtime_root](const std::string& version, const std::string& executable) {
+        std::filesystem::create_directories(runtime_root / version);
+        std::ofstream(runtime_root / version / "msedgewebview2.exe") << executable;
+        std::ofstream(runtime_root / version / "resources.pak") << std::string(4096, 'r');
+    };
+    auto launch = [&runtime_root, &prelaunch_config_path](const std::string& version) {
+        WebViewStandInBackendOptions backend_options;
+        backend_options.runtime_version = version;
+        backend_options.browser_executable_path = runtime_root / version / "msedgewebview2.exe";
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>(backend_options));
+        controller->Launch(prelaunch_config_path);
+        controller->WaitForLaunch();
+        // Close cuts a prefetch short, so let a new version's finish; it is recorded right after.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (ReadRuntimeIdentity(prelaunch_config_path).value_or(WebViewRuntimeIdentity{}).version != version &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        controller->Close(false);
+        controller->WaitForClose();
+        EXPECT_EQ(controller->GetTelemetry().exceptions.size(), 0U);
+        return controller->GetTelemetry();
+    };
+    auto before = WebViewPreLaunchMetrics::Snapshot();
+
+    install_runtime("1.0.0.0", "v1");
+    std::vector<WebViewPreLaunchTelemetry> batch;
+    batch.push_back(launch("1.0.0.0"));
+    EXPECT_EQ(batch.back().cache_miss_reason, "runtime_unknown");
+    EXPECT_EQ(batch.back().runtime_version, "1.0.0.0");
+    auto identity = ReadRuntimeIdentity(prelaunch_config_path);
+    ASSERT_TRUE(identity.has_value());
+    EXPECT_EQ(identity->version, "1.0.0.0");
+    EXPECT_EQ(identity->executable_size, 2U);
+
+    batch.push_back(launch("1.0.0.0"));
+    EXPECT_EQ(batch.back().cache_miss_reason, "");
+    EXPECT_EQ(batch.back().runtime_prefetch_bytes, 0U);
+
+    // An update installs next to the previous version, whose files are prefetched.
+    install_runtime("2.0.0.0", "v2");
+    batch.push_back(launch("2.0.0.0"));
+    EXPECT_EQ(batch.back().cache_miss_reason, "runtime_changed");
+    EXPECT_EQ(batch.back().runtime_prefetch_bytes, 2U + 4096U);
+    EXPECT_EQ(ReadRuntimeIdentity(prelaunch_config_path)->version, "2.0.0.0");
+    std::atomic<bool> stopped = true;
+    EXPECT_EQ(PrefetchRuntimeFiles(runtime_root / "2.0.0.0", stopped), 0U);
+
+    // Replacing the executable under the same version is a change too.
+    install_runtime("2.0.0.0", "v2 patched");
+    batch.push_back(launch("2.0.0.0"));
+    EXPECT_EQ(batch.back().cache_miss_reason, "runtime_changed");
+
+    auto after = WebViewPreLaunchMetrics::Snapshot();
+    EXPECT_EQ(after.counters["runtime_changes"] - before.counters["runtime_changes"], 2U);
+    EXPECT_EQ(AnalyzePreLaunchTelemetry(batch).runtime_changed_runs, 2U);
+}
+
+TEST(PreLaunchStandInTest, DeferredLaunchStrategies) {
+    auto launch = [](const WebViewLaunchStrategyOptions& strategy, std::shared_ptr<WebViewStandInBackend> backend) {
+        WebViewPreLaunchOptions options;
+        options.launch_strategy = strategy;
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend);
+        controller->Launch(CreateTempPrelaunchConfig(), options);
+        return controller;
+    };
+
+    WebViewLaunchStrategyOptions delayed;
+    delayed.strategy = WebViewLaunchStrategy::kDelayed;
+    delayed.delay = std::chrono::milliseconds(200);
+    auto controller = launch(delayed, std::make_shared<WebViewStandInBackend>());
+    controller->WaitForLaunch();
+    EXPECT_EQ(controller->GetTelemetry().launch_strategy, "delayed(200ms)");
+    EXPECT_EQ(controller->GetTelemetry().launch_trigger, "delay_elapsed");
+    EXPECT_GE(controller->GetTelemetry().launch_triggered, delayed.delay);
+    EXPECT_GE(controller->GetTelemetry().launch_phases.front().started, delayed.delay);
+
+    WebViewLaunchStrategyOptions on_milestone;
+    on_milestone.strategy = WebViewLaunchStrategy::kOnMilestone;
+    on_milestone.milestone = "splash_shown";
+    auto backend = std::make_shared<WebViewStandInBackend>();
+    controller = launch(on_milestone, backend);
+    controller->SignalMilestone("config_loaded");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(backend->GetCounters().environments_created, 0U);
+    controller->SignalMilestone("splash_shown");
+    controller->WaitForLaunch();
+    EXPECT_EQ(controller->GetTelemetry().launch_trigger, "milestone");
+    EXPECT_EQ(backend->GetCounters().environments_created, 1U);
+
+    // A milestone that never comes only holds the launch back until the max deferral.
+    on_milestone.max_deferral = std::chrono::milliseconds(100);
+    controller = launch(on_milestone, std::make_shared<WebViewStandInBackend>());
+    controller->WaitForLaunch();
+    EXPECT_EQ(controller->GetTelemetry().launch_trigger, "max_deferral");
+    EXPECT_EQ(controller->GetTelemetry().exceptions.size(), 0U);
+
+    controller->Close(false);
+    controller->WaitForClose();
+}
+
+TEST(PreLaunchStandInTest, CloseWhileLaunchDeferred) {
+    WebViewPreLaunchOptions options;
+    options.launch_strategy.strategy = WebViewLaunchStrategy::kOnMilestone;
+    options.launch_strategy.milestone = "never";
+    auto backend = std::make_shared<WebViewStandInBackend>();
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend);
+    controller->Launch(CreateTempPrelaunchConfig(), options);
+
+    controller->Close(true);
+    controller->WaitForClose();
+    controller->WaitForLaunch();
+    EXPECT_EQ(controller->GetTelemetry().launch_trigger, "closed");
+    EXPECT_TRUE(controller->GetTelemetry().launch_phases.empty());
+    EXPECT_EQ(backend->GetCounters().environments_created, 0U);
+}
+
+TEST(PreLaunchStandInTest, DetachedClose) {
+    WebViewStandInBackendOptions backend_options;
+    backend_options.browser_exit_latency = std::chrono::milliseconds(500);
+    auto backend = std::make_shared<WebViewStandInBackend>(backend_options);
+    WebViewPreLaunchOptions options;
+    options.close_mode = WebViewCloseMode::kDetach;
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(backend);
+    controller->Launch(CreateTempPrelaunchConfig(), options);
+    controller->WaitForLaunch();
+    ASSERT_EQ(controller->GetTelemetry().exceptions.size(), 0U);
+
+    // The host gets on with exiting while the browser still is.
+    auto start = std::chrono::steady_clock::now();
+    controller->Close(true);
+    controller->Close(true);
+    controller->WaitForClose();
+    // Everything the teardown reports is in by now, even though it goes on.
+    auto telemetry = controller->GetTelemetry();
+    EXPECT_EQ(telemetry.runtime_version, "1.0.0.0");
+    std::weak_ptr<WebViewPreLaunchControllerWin> teardown = controller;
+    controller.reset();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, backend_options.browser_exit_latency);
+    EXPECT_FALSE(teardown.expired());
+
+    // The reaper releases the controller once the browser exited and the teardown is done.
+    while (!teardown.expired() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(teardown.expired());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, backend_options.browser_exit_latency);
+    EXPECT_EQ(backend->GetCounters().live_controllers, 0);
+    EXPECT_EQ(backend->GetCounters().live_environments, 0);
+    EXPECT_EQ(telemetry.exceptions.size(), 0U);
+}
+
+TEST(PreLaunchStandInTest, LaunchStrategyABMode) {
+    WebViewPreLaunchOptions options;
+    options.launch_strategy_candidates.resize(2);
+    options.launch_strategy_candidates[1].strategy = WebViewLaunchStrategy::kDelayed;
+    options.launch_strategy_candidates[1].delay = std::chrono::milliseconds(1);
+
+    std::map<std::string, size_t> strategies;
+    auto prelaunch_config_path = CreateTempPrelaunchConfig();
+    for (int run = 0; run < 20; ++run) {
+        auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>());
+        controller->Launch(prelaunch_config_path, options);
+        controller->WaitForLaunch();
+        ++strategies[controller->GetTelemetry().launch_strategy];
+        controller->Close(false);
+        controller->WaitForClose();
+    }
+
+    EXPECT_EQ(strategies.size(), 2U);
+    EXPECT_EQ(strategies["immediate"] + strategies["delayed(1ms)"], 20U);
+}
+
+TEST(PreLaunchStandInTest, MetricsHooks) {
+    std::mutex events_mutex;
+    std::vector<WebViewPreLaunchMilestone> milestones;
+    std::vector<std::string> errors;
+    auto milestone_hook_id = WebViewPreLaunchMetrics::AddMilestoneHook(
+        [&](WebViewPreLaunchMilestone milestone, std::chrono::milliseconds since_launch) {
+            std::lock_guard<std::mutex> lock(events_mutex);
+            milestones.push_back(milestone);
+        });
+    auto error_hook_id = WebViewPreLaunchMetrics::AddErrorHook([&](const std::string& error) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        errors.push_back(error);
+    });
+    auto before = WebViewPreLaunchMetrics::Snapshot();
+
+    auto prelaunch_config_path = CreateTempPrelaunchConfig();
+    auto controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>());
+    controller->Launch(prelaunch_config_path);
+    controller->WaitForLaunch();
+    EXPECT_TRUE(controller->MatchesPreLaunchArgs(WebViewJsonFileArgsSource(prelaunch_config_path).Read()));
+    EXPECT_EQ(controller->GetTelemetry().args_match, "hit");
+    EXPECT_FALSE(controller->AcquirePooledController("", nullptr, [](auto) {}));
+    controller->Close(false);
+    controller->WaitForClose();
+
+    WebViewStandInBackendOptions failing_backend_options;
+    failing_backend_options.controller_creation_result = E_FAIL;
+    controller = std::make_shared<WebViewPreLaunchControllerWin>(std::make_shared<WebViewStandInBackend>(failing_backend_options));
+    controller->Launch(CreateTempPrelaunchConfig());
+    controller->WaitForLaunch();
+    EXPECT_FALSE(controller->MatchesPreLaunchArgs(WebViewCreationArguments()));
+    EXPECT_EQ(controller->GetTelemetry().args_match, "miss");
+    controller->Close(false);
+    controller->WaitForClose();
+
+    WebViewPreLaunchMetrics::RemoveHook(milestone_hook_id);
+    WebViewPreLaunchMetrics::RemoveHook(error_hook_id);
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kReady, std::chrono::milliseconds(1));
+
+    // The first launch reached every milestone in order, the second failed creating its controller.
+    std::vector<WebViewPreLaunchMilestone> expected_milestones = {
+        WebViewPreLaunchMilestone::kLaunchStarted,
+        WebViewPreLaunchMilestone::kLaunchTriggered,
+        WebViewPreLaunchMilestone::kCachedArgsRead,
+        WebViewPreLaunchMilestone::kWindowCreated,
+        WebViewPreLaunchMilestone::kEnvironmentCreated,
+        WebViewPreLaunchMilestone::kControllerCreated,
+        WebViewPreLaunchMilestone::kReady,
+    };
+    ASSERT_GE(milestones.size(), expected_milestones.size());
+    std::vector<WebViewPreLaunchMilestone> first_launch(milestones.begin(), milestones.begin() + expected_milestones.size());
+    std::sort(first_launch.begin() + 2, first_launch.begin() + 4);
+    EXPECT_EQ(first_launch, expected_milestones);
+    EXPECT_EQ(std::count(milestones.begin(), milestones.end(), WebViewPreLaunchMilestone::kReady), 1);
+    EXPECT_EQ(errors.size(), 1U);
+
+    auto after = WebViewPreLaunchMetrics::Snapshot();
+    EXPECT_EQ(after.counters["launches"] - before.counters["launches"], 2U);
+    EXPECT_EQ(after.counters["args_hits"] - before.counters["args_hits"], 1U);
+    EXPECT_EQ(after.counters["args_misses"] - before.counters["args_misses"], 1U);
+    EXPECT_EQ(after.counters["controller_pool_misses"] - before.counters["controller_pool_misses"], 1U);
+    EXPECT_EQ(after.counters["errors"] - before.counters["errors"], 1U);
+    EXPECT_EQ(after.milestone_latencies["ready"].count - before.milestone_latencies["ready"].count, 2U);
+
+    // Phase durations count only phases that completed.
+    EXPECT_EQ(after.phase_durations["read_cached_args"].count - before.phase_durations["read_cached_args"].count, 2U);
+    EXPECT_EQ(after.phase_durations["create_environment"].count - before.phase_durations["create_environment"].count, 2U);
+    EXPECT_EQ(after.phase_durations["create_controller"].count - before.phase_durations["create_controller"].count, 1U);
+}
+
+TEST(MetricsTest, HistogramBuckets) {
+    auto before = WebViewPreLaunchMetrics::Snapshot().milestone_latencies["adopted"];
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kAdopted, std::chrono::milliseconds(0));
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kAdopted, std::chrono::milliseconds(3));
+    WebViewPreLaunchMetrics::RecordMilestone(WebViewPreLaunchMilestone::kAdopted, std::chrono::milliseconds(100000));
+    auto after = WebViewPreLaunchMetrics::Snapshot().milestone_latencies["adopted"];
+
+    ASSERT_EQ(after.buckets.size(), 17U);
+    EXPECT_EQ(after.buckets[0].upper_bound, std::chrono::milliseconds(1));
+    EXPECT_EQ(after.buckets[0].count - before.buckets[0].count, 1U);
+    EXPECT_EQ(after.buckets[2].upper_bound, std::chrono::milliseconds(4));
+    EXPECT_EQ(after.buckets[2].count - before.buckets[2].count, 1U);
+    EXPECT_FALSE(after.buckets.back().upper_bound.has_value());
+    EXPECT_EQ(after.buckets.back().count - before.buckets.back().count, 1U);
+    EXPECT_EQ(after.count - before.count, 3U);
+    EXPECT_EQ((after.sum - before.sum).count(), 100003);
+
+    nlohmann::json j = WebViewPreLaunchMetrics::Snapshot();
+    EXPECT_TRUE(j["milestone_latencies"]["adopted"]["buckets"].back()["upper_bound"].is_null());
+    EXPECT_TRUE(j["counters"].contains("warm_up_timeouts"));
+
+    auto phase_before = WebViewPreLaunchMetrics::Snapshot().phase_durations["create_window"];
+    WebViewPreLaunchMetrics::RecordPhaseDuration(WebViewLaunchPhase::kCreateWindow, std::chrono::milliseconds(5));
+    auto phase_after = WebViewPreLaunchMetrics::Snapshot().phase_durations["create_window"];
+    ASSERT_EQ(phase_after.buckets.size(), 17U);
+    EXPECT_EQ(phase_after.buckets[3].count - phase_before.buckets[3].count, 1U);
+    EXPECT_EQ((phase_after.sum - phase_before.sum).count(), 5);
+    EXPECT_EQ(FindPhase("create_window"), WebViewLaunchPhase::kCreateWindow);
+    EXPECT_FALSE(FindPhase("test_phase").has_value());
+    j = WebViewPreLaunchMetrics::Snapshot();
+    EXPECT_TRUE(j["phase_durations"].contains("create_controller"));
+}
+
+TEST(MetricsTest, RemoveHookWaitsForRunningCalls) {
+    std::binary_semaphore hook_entered(0);
+    std::binary_semaphore hook_released(0);
+    std::atomic<bool> hook_returned = false;
+    auto hook_id = WebViewPreLaunchMetrics::AddErrorHook([&](const std::string&) {
+        hook_entered.release();
+        hook_released.acquire();
+        hook_returned = true;
+    });
+
+    std::thread recording_thread([]() {
+        WebViewPreLaunchMetrics::RecordError("error");
+    });
+    hook_entered.acquire();
+
+    std::atomic<bool> removed = false;
+    std::thread removing_thread([&]() {
+        WebViewPreLaunchMetrics::RemoveHook(hook_id);
+        removed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(removed);
+
+    hook_released.release();
+    removing_thread.join();
+    recording_thread.join();
+    EXPECT_TRUE(hook_returned);
+
+    // A hook removing itself doesn't wait for its own call.
+    WebViewPreLaunchMetrics::HookId self_removing_hook_id = 0;
+    size_t calls = 0;
+    self_removing_hook_id = WebViewPreLaunchMetrics::AddErrorHook([&](const std::string&) {
+        ++calls;
+        WebViewPreLaunchMetrics::RemoveHook(self_removing_hook_id);
+    });
+    WebViewPreLaunchMetrics::RecordError("error");
+    WebViewPreLaunchMetrics::RecordError("error");
+    EXPECT_EQ(calls, 1U);
+}
+
+TEST(PreLaunchStandInTest, MultiTargetLaunch) {
+    WebViewStandInBackendOptions backend_options;
+    backend_options.environment_creation_latency = std::chrono::milliseconds(100);
+    auto backend = std::make_shared<WebViewStandInBackend>(backend_options);
+
+    std::vector<WebViewPreLaunchTarget> targets = {
+        {"tenant_a", CreateTempPrelaunchConfig()},
+        {"tenant_b", CreateTempPrelaunchConfig()},
+        {"tenant_c", CreateTempPrelaunchConfig()},
+    };
+
+    // One launch at a time: each target starts once the one before it is ready.
+    WebViewMultiPreLaunchOptions options;
+    options.max_concurrent_launches = 1;
+    WebViewMultiPreLaunchControllerWin sequential_controller(backend);
+    sequential_controller.Launch(targets, options);
+    EXPECT_TRUE(sequential_controller.WaitForLaunch("tenant_c"));
+    sequential_controller.WaitForLaunch();
+    EXPECT_FALSE(sequential_controller.WaitForLaunch("unknown"));
+    EXPECT_THROW(sequential_controller.GetTelemetry(), std::logic_error);
+    EXPECT_THROW(sequential_controller.Launch(targets, options), std::logic_error);
+    EXPECT_EQ(backend->GetCounters().environments_created, 3U);
+
+    sequential_controller.Close(true);
+    sequential_controller.WaitForClose();
+    EXPECT_EQ(backend->GetCounters().live_environments, 0);
+
+    auto telemetry = sequential_controller.GetTelemetry();
+    ASSERT_EQ(telemetry.size(), 3U);
+    for (const auto& [target, target_telemetry] : telemetry) {
+        EXPECT_EQ(target_telemetry.launch_trigger, "milestone");
+        EXPECT_EQ(target_telemetry.exceptions.size(), 0U);
+    }
+    auto analysis = sequential_controller.AnalyzeTelemetry();
+    EXPECT_EQ(analysis.runs, 3U);
+    EXPECT_EQ(analysis.failed_runs, 0U);
+    // Offsets of all targets count from the same instant.
+    EXPECT_GE(telemetry["tenant_b"].launch_triggered, telemetry["tenant_a"].controller_created);
+    EXPECT_GE(telemetry["tenant_c"].launch_triggered, telemetry["tenant_b"].controller_created);
+
+    // Without a limit every target starts right away.
+    options.max_concurrent_launches = 0;
+    WebViewMultiPreLaunchControllerWin concurrent_controller(backend);
+    concurrent_controller.Launch(targets, options);
+    concurrent_controller.WaitForLaunch();
+    ASSERT_NE(concurrent_controller.GetController("tenant_b"), nullptr);
+    EXPECT_TRUE(concurrent_controller.GetController("tenant_b")->Adopt(nullptr, [](auto, auto) {}));
+
+    concurrent_controller.Close(false);
+    concurrent_controller.WaitForClose();
+    telemetry = concurrent_controller.GetTelemetry();
+    for (const auto& [target, target_telemetry] : telemetry) {
+        EXPECT_LT(target_telemetry.launch_triggered, telemetry["tenant_a"].environment_created);
+    }
+}
+
+TEST(PreLaunchStandInTest, MultiTargetCloseWhileQueued) {
+    WebViewStandInBackendOptions backend_options;
+    backend_options.environment_creation_latency = std::chrono::milliseconds(200);
+    auto backend = std::make_shared<WebViewStandInBackend>(backend_options);
+
+    WebViewMultiPreLaunchControllerWin controller(backend);
+    EXPECT_THROW(controller.Launch({{"tenant_a", CreateTempPrelaunchConfig()}, {"tenant_a", CreateTempPrelaunchConfig()}}),
+                 std::invalid_argument);
+
+    WebViewMultiPreLaunchOptions options;
+    options.max_concurrent_launches = 1;
+    controller.Launch({{"tenant_a", CreateTempPrelaunchConfig()}, {"tenant_b", CreateTempPrelaunchConfig()}}, options);
+    controller.Close(false);
+    controller.WaitForClose();
+
+    // The queued target was never launched, and waiting for it doesn't hang.
+    EXPECT_TRUE(controller.WaitForLaunch("tenant_b"));
+    EXPECT_EQ(controller.GetTelemetry()["tenant_b"].launch_trigger, "closed");
+    EXPECT_LE(backend->GetCounters().environments_created, 1U);
+}
+
+TEST(TelemetryAnalysisTest, StepDurationsAndSaving) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.background_launch_started = std::chrono::milliseconds(1);
+    telemetry.read_cached_args_completed = std::chrono::milliseconds(3);
+    telemetry.window_created = std::chrono::milliseconds(10);
+    telemetry.environment_created = std::chrono::milliseconds(250);
+    telemetry.controller_created = std::chrono::milliseconds(400);
+    telemetry.waitforlaunch_started = std::chrono::milliseconds(300);
+    telemetry.waitforlaunch_completed = std::chrono::milliseconds(401);
+
+    auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+    ASSERT_EQ(analysis.background_phases.size(), 5U);
+    EXPECT_EQ(analysis.background_phases[2].name, "create_window");
+    EXPECT_EQ(analysis.background_phases[2].duration.count(), 7);
+    EXPECT_EQ(analysis.background_phases[3].duration.count(), 240);
+    EXPECT_EQ(analysis.slowest_background_phase, "create_environment");
+    EXPECT_TRUE(analysis.launch_succeeded);
+    EXPECT_EQ(analysis.ready.count(), 400);
+    EXPECT_EQ(analysis.foreground_blocked.count(), 101);
+    ASSERT_TRUE(analysis.overlap_ratio.has_value());
+    EXPECT_DOUBLE_EQ(analysis.overlap_ratio.value(), 0.75);
+    EXPECT_EQ(analysis.estimated_saving.count(), 299);
+}
+
+TEST(TelemetryAnalysisTest, UnrecordedMilestonesAndFailures) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.read_cached_args_completed = std::chrono::milliseconds(5);
+    telemetry.environment_created = std::chrono::milliseconds(50);
+    telemetry.exceptions.push_back("environment creation failed");
+
+    // The skipped window milestone's time is folded into the following phase.
+    auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+    ASSERT_EQ(analysis.background_phases.size(), 2U);
+    EXPECT_EQ(analysis.background_phases[1].name, "create_environment");
+    EXPECT_EQ(analysis.background_phases[1].duration.count(), 45);
+    EXPECT_FALSE(analysis.launch_succeeded);
+    EXPECT_FALSE(analysis.overlap_ratio.has_value());
+    EXPECT_EQ(analysis.estimated_saving.count(), 0);
+}
+
+TEST(TelemetryAnalysisTest, BatchFromJson) {
+    auto batch = nlohmann::json::parse(R"([
+        {"controller_created": 100, "waitforlaunch_started": 100, "waitforlaunch_completed": 100},
+        {"controller_created": 300, "waitforlaunch_started": 100, "waitforlaunch_completed": 300},
+        {"environment_created": 20, "exceptions": ["failed"]}
+    ])").get<std::vector<WebViewPreLaunchTelemetry>>();
+
+    auto analysis = AnalyzePreLaunchTelemetry(batch);
+    EXPECT_EQ(analysis.runs, 3U);
+    EXPECT_EQ(analysis.failed_runs, 1U);
+    EXPECT_EQ(analysis.ready.max.count(), 300);
+    EXPECT_EQ(analysis.foreground_blocked.p50.count(), 0);
+    EXPECT_EQ(analysis.foreground_blocked.p90.count(), 200);
+    ASSERT_TRUE(analysis.mean_overlap_ratio.has_value());
+    EXPECT_NEAR(analysis.mean_overlap_ratio.value(), (1.0 + 1.0 / 3) / 2, 1e-9);
+
+    nlohmann::json j = analysis;
+    EXPECT_EQ(j["run_analyses"].size(), 3U);
+    EXPECT_EQ(j["estimated_saving"]["max"], 100);
+}
+
+TEST(TelemetryAnalysisTest, NonFatalExceptions) {
+    // Ready after warm-up, with one warm-up URL failing along the way.
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.environment_created = std::chrono::milliseconds(200);
+    telemetry.controller_created = std::chrono::milliseconds(300);
+    telemetry.ready = std::chrono::milliseconds(450);
+    telemetry.exceptions.push_back("warm-up URL failed");
+
+    auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+    EXPECT_TRUE(analysis.launch_succeeded);
+    EXPECT_EQ(analysis.ready.count(), 450);
+    EXPECT_EQ(analysis.non_fatal_exceptions, 1U);
+
+    // Without readiness, a controller creation that failed is still a failure.
+    telemetry.ready = std::chrono::milliseconds::zero();
+    analysis = AnalyzePreLaunchTelemetry(telemetry);
+    EXPECT_FALSE(analysis.launch_succeeded);
+    EXPECT_EQ(analysis.non_fatal_exceptions, 0U);
+
+    auto batch_analysis = AnalyzePreLaunchTelemetry(std::vector<WebViewPreLaunchTelemetry>{telemetry});
+    EXPECT_EQ(batch_analysis.failed_runs, 1U);
+    EXPECT_EQ(batch_analysis.runs_with_non_fatal_exceptions, 0U);
+}
+
+TEST(TelemetryAnalysisTest, TelemetryJsonRoundTrip) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.exceptions.push_back("error");
+    telemetry.environment_created = std::chrono::milliseconds(42);
+    telemetry.ready = std::chrono::milliseconds(64);
+    telemetry.cache_miss_reason = "runtime_changed";
+    telemetry.args_source = "mapped_file";
+    telemetry.read_args_duration = std::chrono::microseconds(120);
+    telemetry.controller_pool_refill_latencies.push_back(std::chrono::milliseconds(7));
+    telemetry.warm_up.push_back({"https://example.invalid/", std::chrono::milliseconds(50), std::chrono::milliseconds(20), true, false});
+
+    auto read_telemetry = nlohmann::json(telemetry).get<WebViewPreLaunchTelemetry>();
+    EXPECT_EQ(read_telemetry.exceptions, telemetry.exceptions);
+    EXPECT_EQ(read_telemetry.environment_created, telemetry.environment_created);
+    EXPECT_EQ(read_telemetry.ready, telemetry.ready);
+    EXPECT_EQ(read_telemetry.cache_miss_reason, telemetry.cache_miss_reason);
+    EXPECT_EQ(read_telemetry.args_source, telemetry.args_source);
+    EXPECT_EQ(read_telemetry.read_args_duration, telemetry.read_args_duration);
+    EXPECT_EQ(read_telemetry.controller_pool_refill_latencies, telemetry.controller_pool_refill_latencies);
+    ASSERT_EQ(read_telemetry.warm_up.size(), 1U);
+    EXPECT_EQ(read_telemetry.warm_up[0].url, "https://example.invalid/");
+    EXPECT_TRUE(read_telemetry.warm_up[0].succeeded);
+}
+
+TEST(TelemetryAnalysisTest, LaunchPhaseCriticalPath) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.background_launch_started = std::chrono::milliseconds(1);
+    telemetry.launch_phases = {
+        {"read_cached_args", {}, /*on_worker_thread*/true, std::chrono::milliseconds(1), std::chrono::milliseconds(4)},
+        {"build_options", {"read_cached_args"}, true, std::chrono::milliseconds(4), std::chrono::milliseconds(5)},
+        {"init_apartment", {}, false, std::chrono::milliseconds(1), std::chrono::milliseconds(3)},
+        {"create_window", {"init_apartment"}, false, std::chrono::milliseconds(3), std::chrono::milliseconds(12)},
+        {"request_environment", {"build_options", "create_window"}, false, std::chrono::milliseconds(12), std::chrono::milliseconds(14)},
+    };
+    telemetry.environment_created = std::chrono::milliseconds(200);
+    telemetry.controller_created = std::chrono::milliseconds(260);
+
+    // Reading the args finished while the window was still being created, so it isn't on the path.
+    auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+    EXPECT_EQ(analysis.critical_path, (std::vector<std::string>{
+        "thread_start", "init_apartment", "create_window", "request_environment", "create_environment", "create_controller"}));
+    ASSERT_EQ(analysis.background_phases.size(), 8U);
+    EXPECT_EQ(analysis.background_phases[4].name, "create_window");
+    EXPECT_EQ(analysis.background_phases[4].duration.count(), 9);
+    EXPECT_EQ(analysis.background_phases[6].name, "create_environment");
+    EXPECT_EQ(analysis.background_phases[6].duration.count(), 186);
+    EXPECT_EQ(analysis.slowest_background_phase, "create_environment");
+
+    auto read_telemetry = nlohmann::json(telemetry).get<WebViewPreLaunchTelemetry>();
+    ASSERT_EQ(read_telemetry.launch_phases.size(), 5U);
+    EXPECT_EQ(read_telemetry.launch_phases[4].dependencies, telemetry.launch_phases[4].dependencies);
+    EXPECT_TRUE(read_telemetry.launch_phases[0].on_worker_thread);
+}
+
+TEST(TelemetryAnalysisTest, DeferredLaunch) {
+    WebViewPreLaunchTelemetry telemetry;
+    telemetry.background_launch_started = std::chrono::milliseconds(1);
+    telemetry.launch_strategy = "delayed(500ms)";
+    telemetry.launch_trigger = "delay_elapsed";
+    telemetry.launch_triggered = std::chrono::milliseconds(501);
+    telemetry.launch_phases = {
+        {"read_cached_args", {}, /*on_worker_thread*/false, std::chrono::milliseconds(501), std::chrono::milliseconds(502)},
+    };
+    telemetry.environment_created = std::chrono::milliseconds(700);
+    telemetry.controller_created = std::chrono::milliseconds(800);
+    telemetry.waitforlaunch_started = std::chrono::milliseconds(750);
+    telemetry.waitforlaunch_completed = std::chrono::milliseconds(800);
+
+    // The deferral is on the critical path, but isn't counted as saved work.
+    auto analysis = AnalyzePreLaunchTelemetry(telemetry);
+    EXPECT_EQ(analysis.critical_path, (std::vector<std::string>{
+        "thread_start", "launch_deferred", "read_cached_args", "create_environment", "create_controller"}));
+    EXPECT_EQ(analysis.background_phases[1].duration.count(), 500);
+    EXPECT_EQ(analysis.estimated_saving.count(), 250);
+
+    auto read_telemetry = nlohmann::json(telemetry).get<WebViewPreLaunchTelemetry>();
+    EXPECT_EQ(read_telemetry.launch_strategy, telemetry.launch_strategy);
+    EXPECT_EQ(read_telemetry.launch_trigger, telemetry.launch_trigger);
+    EXPECT_EQ(read_telemetry.launch_triggered, telemetry.launch_triggered);
+}
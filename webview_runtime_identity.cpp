@@ -0,0 +1,98 @@
+#include "webview_runtime_identity.hpp"
+
+#include <boost/nowide/convert.hpp>
+#include <fstream>
+#include <vector>
+
+namespace {
+// The runtime files read while the browser starts, largest first.  Together they are the bulk of
+// what a cold start waits on the disk for.
+constexpr const char* kPrefetchedRuntimeFiles[] = {
+    "msedge.dll",
+    "msedgewebview2.exe",
+    "icudtl.dat",
+    "resources.pak",
+    "v8_context_snapshot.bin",
+    "msedge_elf.dll",
+};
+
+constexpr size_t kPrefetchChunkSize = 1 << 20;
+}  // namespace
+
+void to_json(nlohmann::json& j, const WebViewRuntimeIdentity& identity) {
+    j = nlohmann::json{
+        {"executable_path", boost::nowide::narrow(identity.executable_path.wstring())},
+        {"version", identity.version},
+        {"executable_write_time", identity.executable_write_time},
+        {"executable_size", identity.executable_size}
+    };
+}
+
+void from_json(const nlohmann::json& j, WebViewRuntimeIdentity& identity) {
+    identity.executable_path = boost::nowide::widen(j.at("executable_path").get<std::string>());
+    j.at("version").get_to(identity.version);
+    j.at("executable_write_time").get_to(identity.executable_write_time);
+    j.at("executable_size").get_to(identity.executable_size);
+}
+
+std::filesystem::path GetRuntimeIdentityPath(const std::filesystem::path& cache_args_path) {
+    auto identity_path = cache_args_path;
+    identity_path += ".runtime.json";
+    return identity_path;
+}
+
+std::optional<WebViewRuntimeIdentity> ReadRuntimeIdentity(const std::filesystem::path& cache_args_path) noexcept try {
+    std::ifstream identity_file(GetRuntimeIdentityPath(cache_args_path));
+    if (!identity_file.is_open()) {
+        return std::nullopt;
+    }
+
+    nlohmann::json j;
+    identity_file >> j;
+    return j.get<WebViewRuntimeIdentity>();
+}
+catch(...) {
+    // An unreadable identity is as good as none; the next launch writes a new one.
+    return std::nullopt;
+}
+
+void WriteRuntimeIdentity(const std::filesystem::path& cache_args_path, const WebViewRuntimeIdentity& identity) {
+    auto identity_path = GetRuntimeIdentityPath(cache_args_path);
+    auto temp_path = identity_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream identity_file(temp_path);
+        identity_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        identity_file << nlohmann::json(identity);
+    }
+    std::filesystem::rename(temp_path, identity_path);
+}
+
+WebViewRuntimeIdentity GetRuntimeIdentity(const std::filesystem::path& executable_path, const std::string& version) {
+    WebViewRuntimeIdentity identity;
+    identity.executable_path = executable_path;
+    identity.version = version;
+    identity.executable_write_time = std::filesystem::last_write_time(executable_path).time_since_epoch().count();
+    identity.executable_size = std::filesystem::file_size(executable_path);
+    return identity;
+}
+
+uint64_t PrefetchRuntimeFiles(const std::filesystem::path& runtime_dir, const std::atomic<bool>& stop) {
+    std::vector<char> buffer(kPrefetchChunkSize);
+    uint64_t bytes_read = 0;
+    for (const char* file_name : kPrefetchedRuntimeFiles) {
+        std::ifstream runtime_file(runtime_dir / file_name, std::ios::binary);
+        if (!runtime_file.is_open()) {
+            continue;
+        }
+
+        // Sequential reads of large chunks, which the OS turns into read-ahead.
+        while (!stop && (runtime_file.read(buffer.data(), buffer.size()) || runtime_file.gcount() > 0)) {
+            bytes_read += static_cast<uint64_t>(runtime_file.gcount());
+        }
+        if (stop) {
+            break;
+        }
+    }
+    return bytes_read;
+}
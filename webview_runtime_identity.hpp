@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+// The browser runtime a pre-launched tree last ran against.  Kept next to the cached args so the
+// next launch can tell that the runtime was updated in between, in which case none of its files
+// are in the OS file cache and the launch is a cold start.
+struct WebViewRuntimeIdentity {
+  // The browser executable the tree was started from.  Stored as UTF-8, like the cached args'
+  // paths, so that paths outside the system code page survive the round trip.
+  std::filesystem::path executable_path;
+  std::string version;
+  // The executable's last write time, in file clock ticks, and size.  They catch a fixed version
+  // runtime being replaced in place under the same version.
+  int64_t executable_write_time = 0;
+  uint64_t executable_size = 0;
+
+  bool operator==(const WebViewRuntimeIdentity& other) const = default;
+};
+
+void to_json(nlohmann::json& j, const WebViewRuntimeIdentity& identity);
+void from_json(const nlohmann::json& j, WebViewRuntimeIdentity& identity);
+
+// Where the runtime identity for the args cached at |cache_args_path| is stored.  A file of its
+// own, since hosts rewrite the args file whenever their args change.
+std::filesystem::path GetRuntimeIdentityPath(const std::filesystem::path& cache_args_path);
+
+// Nullopt when no identity was stored for |cache_args_path| or it couldn't be read.
+std::optional<WebViewRuntimeIdentity> ReadRuntimeIdentity(const std::filesystem::path& cache_args_path) noexcept;
+// Written to a temporary file that then replaces the stored identity, so that a launch reading it
+// concurrently sees either the old or the new one.
+void WriteRuntimeIdentity(const std::filesystem::path& cache_args_path, const WebViewRuntimeIdentity& identity);
+
+// The identity of the runtime whose executable is |executable_path|.  Throws
+// std::filesystem::filesystem_error if the executable can't be found.
+WebViewRuntimeIdentity GetRuntimeIdentity(const std::filesystem::path& executable_path, const std::string& version);
+
+// Reads the largest files of the runtime installed in |runtime_dir| once, so that starting the
+// browser from there finds them in the OS file cache.  Missing files are skipped.  Stops between
+// chunks once |stop| is set.  Returns the number of bytes read, so far when stopped.
+uint64_t PrefetchRuntimeFiles(const std::filesystem::path& runtime_dir, const std::atomic<bool>& stop);